@@ -4,18 +4,30 @@
 
 #include <utility>
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
 
 template <typename T>
 inline digit_t to_digit_t(T x) {
   return static_cast<digit_t>(x);
 }
 
-template <typename T>
-inline overflow_t to_overflow_t(T x) {
-  return static_cast<overflow_t>(x);
+//  a reciprocal is as long as the divisor, so it pays off only when the
+//  quotient is long too; shorter quotients go to limbs::divrem
+inline bool newton_pays(size_t an, size_t bn) {
+  return bn >= limbs::NEWTON_DIV_THRESHOLD
+         && an >= bn + limbs::NEWTON_DIV_THRESHOLD;
+}
+
+big_integer::big_integer(uint32_t a) : sign(0), data(to_digit_t(a)) {
+  strip();
 }
 
-big_integer::big_integer(digit_t a) : sign(0), data(a) {
+big_integer::big_integer(uint64_t a) : sign(0), data(to_digit_t(a)) {
+  if (DIGITS < 64) {
+    data.push_back(to_digit_t(a >> (DIGITS % 64)));
+  }
   strip();
 }
 
@@ -27,21 +39,90 @@ big_integer::big_integer(int a) : sign(to_digit_t(-(a < 0))),
 big_integer::big_integer() : big_integer(0) {
 }
 
-big_integer::big_integer(std::string const& str) : big_integer() {
+//  the digits of every radix up to 36
+char const RADIX_DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+//  value of a digit in any radix up to 36, or 36 for other characters
+unsigned digit_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return static_cast<unsigned>(c - '0');
+  }
+  if (c >= 'a' && c <= 'z') {
+    return static_cast<unsigned>(c - 'a' + 10);
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return static_cast<unsigned>(c - 'A' + 10);
+  }
+  return 36;
+}
+
+//  number of digits in a limb-sized chunk: radix^chunk_digits(radix) is the
+//  largest power of radix that fits in a limb
+size_t chunk_digits(unsigned radix) {
+  size_t digits = 1;
+  for (digit_t chunk = radix; chunk <= MAX_DIGIT / radix; chunk *= radix) {
+    digits++;
+  }
+  return digits;
+}
+
+//  log2(radix) for the powers of two, 0 for the other radixes
+unsigned radix_bits(unsigned radix) {
+  unsigned bits = 0;
+  while ((1u << bits) < radix) {
+    bits++;
+  }
+  return (1u << bits) == radix ? bits : 0;
+}
+
+void check_radix(unsigned radix) {
+  if (radix < 2 || radix > 36) {
+    throw std::invalid_argument("radix must be in range [2, 36]");
+  }
+}
+
+//  radix^chunk_digits(radix)
+digit_t chunk_value(unsigned radix) {
+  digit_t chunk = radix;
+  while (chunk <= MAX_DIGIT / radix) {
+    chunk *= radix;
+  }
+  return chunk;
+}
+
+//  powers[k] = radix^(chunk_digits * 2^k) while that has fewer than n digits
+std::vector<big_integer> radix_powers(unsigned radix, size_t n) {
+  size_t digits = chunk_digits(radix);
+  std::vector<big_integer> powers{chunk_value(radix)};
+  while ((digits << powers.size()) < n) {
+    powers.push_back(sqr(powers.back()));
+  }
+  return powers;
+}
+
+big_integer::big_integer(std::string const& str) : big_integer(str, 10) {
+}
+
+big_integer::big_integer(std::string const& str, unsigned radix)
+        : big_integer() {
+  check_radix(radix);
   if (!str.empty()) {
-    int result_sign = 1;
+    bool negative = false;
     size_t pos = 0;
     if (str[0] == '-') {
-      result_sign = -1;
+      negative = true;
       pos++;
     } else if (str[0] == '+') {
       pos++;
     }
-    for (; pos < str.size(); pos++) {
-      if (str[pos] < '0' || str[pos] > '9') {
+    for (size_t i = pos; i < str.size(); i++) {
+      if (digit_value(str[i]) >= radix) {
         throw std::invalid_argument("invalid bigint representation");
       }
-      (*this *= 10) += (str[pos] - '0') * result_sign;
+    }
+    *this = read_digits(str.data() + pos, str.size() - pos, radix);
+    if (negative) {
+      *this = -*this;
     }
   }
 }
@@ -49,18 +130,20 @@ big_integer::big_integer(std::string const& str) : big_integer() {
 template <bool add>
 big_integer& big_integer::add_sub(big_integer const& rhs) {
   assure_size(std::max(size(), rhs.size()));
-  bool carry = false;
+  size_t n = rhs.size();
+  size_t tail = size() - n;
   digit_t* data_ptr = data.data();
   digit_t const* rhs_ptr = rhs.data.data();
-  for (size_t i = 0; i < size(); i++) {
-    overflow_t temp = data_ptr[i];
-    if (add) {
-      (temp += (i < rhs.size() ? rhs_ptr[i] : rhs.sign)) += carry;
-    } else {
-      (temp -= (i < rhs.size() ? rhs_ptr[i] : rhs.sign)) -= carry;
-    }
-    data_ptr[i] = to_digit_t(temp);
-    carry = temp > MAX_DIGIT;
+  digit_t carry = add ? limbs::add_n(data_ptr, data_ptr, rhs_ptr, n)
+                      : limbs::sub_n(data_ptr, data_ptr, rhs_ptr, n);
+  //  past its limbs rhs is its sign repeated; MAX_DIGIT limbs are
+  //  -1 modulo BASE^tail, so with a carry in they leave the rest as is
+  if (rhs.sign == 0) {
+    carry = add ? limbs::add_1(data_ptr + n, data_ptr + n, tail, carry)
+                : limbs::sub_1(data_ptr + n, data_ptr + n, tail, carry);
+  } else if (carry == 0) {
+    carry = 1 - (add ? limbs::sub_1(data_ptr + n, data_ptr + n, tail, 1)
+                     : limbs::add_1(data_ptr + n, data_ptr + n, tail, 1));
   }
   overflow_t one_more_ot = sign;
   if (add) {
@@ -105,9 +188,19 @@ bool operator==(big_integer const& a, big_integer const& b) {
   return a.sign == b.sign && a.data == b.data;
 }
 
+big_integer& big_integer::negate() {
+  sign ^= MAX_DIGIT;
+  digit_t* data_ptr = data.data();
+  for (size_t i = 0; i < size(); i++) {
+    data_ptr[i] ^= MAX_DIGIT;
+  }
+  return *this += 1;
+}
+
 big_integer big_integer::operator-() const {
   big_integer temp = ~*this;
-  return temp += 1;
+  temp += 1;
+  return temp;
 }
 
 big_integer big_integer::operator+() const {
@@ -129,36 +222,136 @@ big_integer& big_integer::operator++() {
 }
 
 big_integer operator+(big_integer a, big_integer const& b) {
-  return a += b;
+  a += b;
+  return a;
+}
+
+big_integer operator+(big_integer const& a, big_integer&& b) {
+  b += a;
+  return std::move(b);
+}
+
+big_integer operator+(big_integer&& a, big_integer&& b) {
+  if (b.data.capacity() > a.data.capacity()) {
+    b += a;
+    return std::move(b);
+  }
+  a += b;
+  return std::move(a);
 }
 
 big_integer operator-(big_integer a, big_integer const& b) {
-  return a -= b;
+  a -= b;
+  return a;
+}
+
+big_integer operator-(big_integer const& a, big_integer&& b) {
+  b -= a;
+  return std::move(b.negate());
+}
+
+big_integer operator-(big_integer&& a, big_integer&& b) {
+  if (b.data.capacity() > a.data.capacity()) {
+    b -= a;
+    return std::move(b.negate());
+  }
+  a -= b;
+  return std::move(a);
 }
 
 big_integer operator&(big_integer a, big_integer const& b) {
-  return a &= b;
+  a &= b;
+  return a;
+}
+
+big_integer operator&(big_integer const& a, big_integer&& b) {
+  b &= a;
+  return std::move(b);
+}
+
+big_integer operator&(big_integer&& a, big_integer&& b) {
+  if (b.data.capacity() > a.data.capacity()) {
+    b &= a;
+    return std::move(b);
+  }
+  a &= b;
+  return std::move(a);
 }
 
 big_integer operator|(big_integer a, big_integer const& b) {
-  return a |= b;
+  a |= b;
+  return a;
+}
+
+big_integer operator|(big_integer const& a, big_integer&& b) {
+  b |= a;
+  return std::move(b);
+}
+
+big_integer operator|(big_integer&& a, big_integer&& b) {
+  if (b.data.capacity() > a.data.capacity()) {
+    b |= a;
+    return std::move(b);
+  }
+  a |= b;
+  return std::move(a);
 }
 
 big_integer operator^(big_integer a, big_integer const& b) {
-  return a ^= b;
+  a ^= b;
+  return a;
+}
+
+big_integer operator^(big_integer const& a, big_integer&& b) {
+  b ^= a;
+  return std::move(b);
+}
+
+big_integer operator^(big_integer&& a, big_integer&& b) {
+  if (b.data.capacity() > a.data.capacity()) {
+    b ^= a;
+    return std::move(b);
+  }
+  a ^= b;
+  return std::move(a);
 }
 
 big_integer& big_integer::operator*=(big_integer const& rhs) {
   return *this = *this * rhs;
 }
 
-big_integer& big_integer::apply_bitwise_op(big_integer const& rhs,
-                                           std::function<digit_t(digit_t,
-                                                                 digit_t)> const& op) {
+template <typename Op>
+inline void bitwise_n(digit_t* r, digit_t const* a, digit_t const* b,
+                      size_t n, Op op) {
+  for (size_t i = 0; i < n; i++) {
+    r[i] = op(a[i], b[i]);
+  }
+}
+
+//  the standard operators run on the vector kernels of the cpu
+inline void bitwise_n(digit_t* r, digit_t const* a, digit_t const* b,
+                      size_t n, std::bit_and<>) {
+  limbs::and_n(r, a, b, n);
+}
+
+inline void bitwise_n(digit_t* r, digit_t const* a, digit_t const* b,
+                      size_t n, std::bit_or<>) {
+  limbs::ior_n(r, a, b, n);
+}
+
+inline void bitwise_n(digit_t* r, digit_t const* a, digit_t const* b,
+                      size_t n, std::bit_xor<>) {
+  limbs::xor_n(r, a, b, n);
+}
+
+template <typename Op>
+big_integer& big_integer::apply_bitwise_op(big_integer const& rhs, Op op) {
   assure_size(rhs.size());
+  size_t n = rhs.size();
   digit_t* data_ptr = data.data();
-  for (size_t i = 0; i < size(); i++) {
-    data_ptr[i] = op(data[i], rhs.digit_at(i));
+  bitwise_n(data_ptr, data_ptr, rhs.data.data(), n, op);
+  for (size_t i = n; i < size(); i++) {
+    data_ptr[i] = op(data_ptr[i], rhs.sign);
   }
   sign = op(sign, rhs.sign);
   return strip();
@@ -237,36 +430,107 @@ big_integer big_integer::abs() const {
   return is_negative() ? -*this : *this;
 }
 
-//  both numbers are non-negative
-big_integer multiply_by_digit(big_integer const& a, digit_t b) {
+big_integer operator*(big_integer const& a, big_integer const& b) {
+  if (&a == &b || (a.sign == b.sign && a.data.shares_storage(b.data))) {
+    return sqr(a);
+  }
+  //  only negative operands need a copy for their magnitude
+  big_integer a_abs, b_abs;
+  big_integer const& x = a.is_negative() ? a_abs = -a : a;
+  big_integer const& y = b.is_negative() ? b_abs = -b : b;
+  if (x.size() == 0 || y.size() == 0) {
+    return 0;
+  }
   big_integer result;
-  result.assure_size(a.size() + 1);
-  digit_t* data_ptr = result.data.data();
-  digit_t const* a_ptr = a.data.data();
-  digit_t carry = 0;
-  for (size_t i = 0; i < a.size(); i++) {
-    overflow_t product = to_overflow_t(a_ptr[i]) * b + carry;
-    data_ptr[i] = to_digit_t(product);
-    carry = to_digit_t(product >> DIGITS);
+  result.assure_size(x.size() + y.size());
+  limbs::mul(result.data.data(), std::as_const(x.data).data(), x.size(),
+             std::as_const(y.data).data(), y.size());
+  result.strip().set_sign(a.sign ^ b.sign);
+  return result;
+}
+
+big_integer& big_integer::accumulate_product(big_integer const& a,
+                                             big_integer const& b,
+                                             bool subtract) {
+  if (&a == this || &b == this) {
+    big_integer copy = *this;
+    return accumulate_product(&a == this ? copy : a, &b == this ? copy : b,
+                              subtract);
+  }
+  big_integer a_abs, b_abs;
+  big_integer const& x = a.is_negative() ? a_abs = -a : a;
+  big_integer const& y = b.is_negative() ? b_abs = -b : b;
+  if (x.size() == 0 || y.size() == 0) {
+    return *this;
+  }
+  subtract ^= a.is_negative() != b.is_negative();
+  //  the sum fits in n signed limbs, so it is computed modulo BASE^n on
+  //  the two's complement limbs and the sign is read from the top
+  size_t pn = x.size() + y.size();
+  assure_size(std::max(size(), pn) + 1);
+  size_t n = size();
+  digit_t* r = data.data();
+  digit_t const* xd = std::as_const(x.data).data();
+  digit_t const* yd = std::as_const(y.data).data();
+  if (subtract) {
+    digit_t borrow = limbs::submul(r, xd, x.size(), yd, y.size());
+    limbs::sub_1(r + pn, r + pn, n - pn, borrow);
+  } else {
+    digit_t carry = limbs::addmul(r, xd, x.size(), yd, y.size());
+    limbs::add_1(r + pn, r + pn, n - pn, carry);
   }
-  result.data.back() = carry;
-  return result.strip();
+  sign = r[n - 1] >> (DIGITS - 1) == 0 ? 0 : MAX_DIGIT;
+  return strip();
 }
 
-big_integer operator*(big_integer a, big_integer b) {
-  digit_t result_sign = a.sign ^b.sign;
-  a = a.abs();
-  b = b.abs();
-  if (b.size() > a.size()) {
-    a.data.swap(b.data);
+big_integer& big_integer::addmul(big_integer const& a, big_integer const& b) {
+  return accumulate_product(a, b, false);
+}
+
+big_integer& big_integer::submul(big_integer const& a, big_integer const& b) {
+  return accumulate_product(a, b, true);
+}
+
+big_integer mulmod(big_integer const& a, big_integer const& b,
+                   big_integer const& m) {
+  if (m == 0) {
+    throw std::invalid_argument("division by zero");
   }
-  digit_t const* b_ptr = b.data.data();
-  big_integer result;
-  for (size_t i = 0; i < b.size(); i++) {
-    result += multiply_by_digit(a, b_ptr[i]);
-    a.data.push_front(0);
+  big_integer a_abs, b_abs, m_abs;
+  big_integer const& x = a.is_negative() ? a_abs = -a : a;
+  big_integer const& y = b.is_negative() ? b_abs = -b : b;
+  big_integer const& d = m.is_negative() ? m_abs = -m : m;
+  size_t pn = x.size() + y.size();
+  if (x.size() == 0 || y.size() == 0) {
+    return 0;
+  }
+  if (pn < d.size() || newton_pays(pn, d.size())) {
+    return a * b % m;
   }
-  return result.set_sign(result_sign);
+  //  the product and the quotient stay in scratch, only the remainder is
+  //  a new number
+  std::unique_ptr<digit_t[]> buf(new digit_t[2 * pn - d.size() + 1]);
+  digit_t* p = buf.get();
+  limbs::mul(p, std::as_const(x.data).data(), x.size(),
+             std::as_const(y.data).data(), y.size());
+  big_integer r;
+  r.assure_size(d.size());
+  limbs::divrem(p + pn, r.data.data(), p, pn,
+                std::as_const(d.data).data(), d.size());
+  r.strip().set_sign(a.sign ^ b.sign);
+  return r;
+}
+
+big_integer sqr(big_integer const& a) {
+  big_integer abs = a.abs();
+  if (abs.size() == 0) {
+    return 0;
+  }
+  big_integer result;
+  result.assure_size(2 * abs.size());
+  limbs::sqr(result.data.data(), std::as_const(abs.data).data(), abs.size());
+  result.strip();
+  return result;
 }
 
 big_integer& big_integer::operator/=(big_integer const& rhs) {
@@ -285,6 +549,128 @@ big_integer operator%(big_integer const& a, big_integer const& b) {
   return divmod(a, b).second;
 }
 
+//  about 2^(2n) / d for 2^(n - 1) <= d < 2^n, off by a few units at most:
+//  the top half of d gives a half-precision reciprocal x, then one Newton
+//  step x + x * (2^(2n) - d * x) / 2^(2n) doubles its precision
+big_integer big_integer::approx_reciprocal(big_integer const& d, size_t n) {
+  if (d.size() < limbs::NEWTON_DIV_THRESHOLD) {
+    return (big_integer(1) << static_cast<int>(2 * n)) / d;
+  }
+  size_t h = n / 2 + 2;
+  int shift = static_cast<int>(n - h);
+  //  x = y * 2^shift, so both products below are taken with the short y
+  big_integer y = approx_reciprocal(d >> shift, h);
+  big_integer e = (big_integer(1) << static_cast<int>(n + h)) - d * y;
+  return (y << shift) + ((y * e) >> static_cast<int>(2 * h));
+}
+
+//  a / b and a mod b for 0 <= a < 2^(2n), where b has n bits and
+//  x = approx_reciprocal(b, n); the estimate is off by a few units
+std::pair<big_integer, big_integer>
+big_integer::newton_step(big_integer const& a, big_integer const& b,
+                         big_integer const& x, size_t n) {
+  big_integer q = ((a >> static_cast<int>(n - 1)) * x)
+                  >> static_cast<int>(n + 1);
+  big_integer r = a - q * b;
+  for (; r < 0; q--) {
+    r += b;
+  }
+  for (; r >= b; q++) {
+    r -= b;
+  }
+  return {std::move(q), std::move(r)};
+}
+
+//  a / b and a mod b for positive a and b by a reciprocal of b, a is
+//  consumed from the top in blocks of bn - 1 limbs like a long division:
+//  the remainder below b on top of a block stays under 2^(2n), and the
+//  block quotient is written straight into its limbs of q
+std::pair<big_integer, big_integer>
+big_integer::newton_divmod(big_integer const& a, big_integer const& b) {
+  size_t n = b.bit_length();
+  big_integer x = approx_reciprocal(b, n);
+  size_t an = a.size();
+  size_t k = b.size() - 1;
+  digit_t const* ap = std::as_const(a.data).data();
+  size_t pos = an > k ? an - k : 0;
+  big_integer q, r;
+  q.assure_size(pos);
+  r.assure_size(an - pos);
+  std::copy(ap + pos, ap + an, r.data.data());
+  r.strip();
+  while (pos > 0) {
+    size_t c = std::min(k, pos);
+    pos -= c;
+    big_integer top;
+    top.assure_size(c + r.size());
+    digit_t* tp = top.data.data();
+    std::copy(ap + pos, ap + pos + c, tp);
+    std::copy_n(std::as_const(r.data).data(), r.size(), tp + c);
+    top.strip();
+    auto qr = newton_step(top, b, x, n);
+    std::copy_n(std::as_const(qr.first.data).data(), qr.first.size(),
+                q.data.data() + pos);
+    r = std::move(qr.second);
+  }
+  q.strip();
+  return {std::move(q), std::move(r)};
+}
+
+size_t big_integer::bit_length() const {
+  return size() == 0 ? 0 : size() * DIGITS
+                           - limbs::leading_zeros(data.back());
+}
+
+size_t big_integer::magnitude_bits() const {
+  if (!is_negative()) {
+    return bit_length();
+  }
+  //  |a| - 1 is ~a, and |a| has one more bit when ~a is all ones
+  digit_t const* d = data.data();
+  size_t n = size();
+  if (n == 0) {
+    return 1;
+  }
+  digit_t top = ~d[n - 1];
+  size_t bits = n * DIGITS - limbs::leading_zeros(top);
+  bool all_ones = (top & (top + 1)) == 0
+                  && std::all_of(d, d + n - 1, [](digit_t x) {
+                       return x == 0;
+                     });
+  return bits + all_ones;
+}
+
+big_integer reciprocal(big_integer const& a, size_t precision) {
+  if (a == 0) {
+    throw std::invalid_argument("division by zero");
+  }
+  big_integer b = a.abs();
+  big_integer p = big_integer(1) << static_cast<int>(precision);
+  if (!newton_pays(p.size(), b.size())) {
+    return p / a;
+  }
+  big_integer q = big_integer::newton_divmod(p, b).first;
+  q.set_sign(a.sign);
+  return q;
+}
+
+//  the quotient is truncated like operator/, the remainder is returned
+//  without the sign of a
+std::pair<big_integer, digit_t> divmod_small(big_integer a, digit_t b) {
+  if (b == 0) {
+    throw std::invalid_argument("division by zero");
+  }
+  digit_t sign = a.sign;
+  a = a.abs();
+  if (a.size() == 0) {
+    return {std::move(a), 0};
+  }
+  digit_t* data = a.data.data();
+  digit_t r = limbs::divrem_1(data, data, a.size(), b);
+  a.strip().set_sign(sign);
+  return {std::move(a), r};
+}
+
 std::pair<big_integer, big_integer> divmod(big_integer a, big_integer b) {
   if (b == 0) {
     throw std::invalid_argument("division by zero");
@@ -293,31 +679,32 @@ std::pair<big_integer, big_integer> divmod(big_integer a, big_integer b) {
   digit_t r_sign = a.sign;
   a = a.abs();
   b = b.abs();
-  int shift = 0;
-  for (overflow_t b_first = b.data.back(); b_first < BASE / 2;
-       shift++, b_first *= 2) {
+  if (a.size() < b.size()) {
+    a.set_sign(r_sign);
+    return {0, std::move(a)};
   }
-  a <<= shift;
-  b <<= shift;
-  big_integer q, r;
-  q.assure_size(a.size());
-  digit_t const* a_ptr = a.data.data();
-  digit_t* q_ptr = q.data.data();
-  for (size_t i = a.size(); i-- > 0;) {
-    r.data.push_front(0);
-    r += a_ptr[i];
-    overflow_t divi = (to_overflow_t(r.digit_at(b.data.size())) << DIGITS) |
-                      r.digit_at(b.data.size() - 1);
-    digit_t quo = to_digit_t(divi / b.data.back());
-    r -= multiply_by_digit(b, quo);
-    while (r.is_negative()) {
-      r += b;
-      quo--;
-    }
-    q_ptr[i] = quo;
+  if (b.size() == 1) {
+    auto qr = divmod_small(a, b.digit_at(0));
+    big_integer r(qr.second);
+    qr.first.set_sign(q_sign);
+    r.set_sign(r_sign);
+    return {std::move(qr.first), std::move(r)};
   }
-  r >>= shift;
-  return {q.set_sign(q_sign).strip(), r.set_sign(r_sign)};
+  if (newton_pays(a.size(), b.size())) {
+    auto qr = big_integer::newton_divmod(a, b);
+    qr.first.set_sign(q_sign);
+    qr.second.set_sign(r_sign);
+    return qr;
+  }
+  big_integer q, r;
+  q.assure_size(a.size() - b.size() + 1);
+  r.assure_size(b.size());
+  limbs::divrem(q.data.data(), r.data.data(),
+                std::as_const(a.data).data(), a.size(),
+                std::as_const(b.data).data(), b.size());
+  q.strip().set_sign(q_sign);
+  r.strip().set_sign(r_sign);
+  return {std::move(q), std::move(r)};
 }
 
 big_integer& big_integer::set_sign(digit_t new_sign) {
@@ -328,23 +715,21 @@ big_integer& big_integer::operator<<=(int rhs) {
   if (rhs < 0) {
     return *this >>= (-rhs);
   }
-  data.push_front(0, rhs / DIGITS);
-  data.push_back(sign);
-  digit_t carry = 0;
+  size_t whole = rhs / DIGITS;
   unsigned left = rhs % DIGITS;
-  digit_t* data_ptr = data.data();
+  data.push_front(0, whole);
   if (left != 0) {
-    for (size_t i = 0; i < size(); i++) {
-      std::tie(data_ptr[i], carry) = std::make_pair(
-              (data_ptr[i] << left) | carry,
-              data_ptr[i] >> (DIGITS - left));
-    }
+    //  the sign limb takes the bits shifted out at the top
+    data.push_back(sign);
+    digit_t* data_ptr = data.data();
+    limbs::lshift(data_ptr + whole, data_ptr + whole, size() - whole, left);
   }
   return strip();
 }
 
 big_integer operator<<(big_integer a, int b) {
-  return a <<= b;
+  a <<= b;
+  return a;
 }
 
 big_integer& big_integer::operator>>=(int rhs) {
@@ -352,34 +737,265 @@ big_integer& big_integer::operator>>=(int rhs) {
     return *this <<= (-rhs);
   }
   data.pop_front(std::min<size_t>(data.size(), rhs / DIGITS));
-  digit_t carry = sign;
-  unsigned left = rhs % DIGITS;
-  if (left != 0) {
+  unsigned right = rhs % DIGITS;
+  if (right != 0 && !data.empty()) {
     digit_t* data_ptr = data.data();
-    for (size_t i = size(); i-- > 0;) {
-      std::tie(data_ptr[i], carry) = std::make_pair(
-              (carry << (DIGITS - left)) | (data_ptr[i] >> left),
-              data_ptr[i] & ((static_cast<digit_t>(1) << left) - 1));
-    }
+    limbs::rshift(data_ptr, data_ptr, size(), right);
+    data_ptr[size() - 1] |= sign << (DIGITS - right);
   }
   return strip();
 }
 
 big_integer operator>>(big_integer a, int b) {
-  return a >>= b;
+  a >>= b;
+  return a;
+}
+
+//  the value of the n valid digits at str in any radix
+big_integer big_integer::read_digits(char const* str, size_t n,
+                                     unsigned radix) {
+  if (radix_bits(radix) != 0) {
+    return read_bits(str, n, radix_bits(radix));
+  }
+  size_t chunks = (n + chunk_digits(radix) - 1) / chunk_digits(radix);
+  if (chunks < limbs::DC_FROM_STRING_THRESHOLD) {
+    return read_radix(str, n, radix, {});
+  }
+  return read_radix(str, n, radix, radix_powers(radix, n));
+}
+
+//  the value of the n digits at str in a radix that is a power of two,
+//  bits per digit, placed straight into the limbs
+big_integer big_integer::read_bits(char const* str, size_t n, unsigned bits) {
+  big_integer result;
+  result.assure_size(n * bits / DIGITS + 2);
+  digit_t* data = result.data.data();
+  size_t pos = 0;
+  for (size_t i = n; i-- > 0; pos += bits) {
+    overflow_t value = static_cast<overflow_t>(digit_value(str[i]))
+                       << (pos % DIGITS);
+    data[pos / DIGITS] |= static_cast<digit_t>(value);
+    data[pos / DIGITS + 1] |= static_cast<digit_t>(value >> DIGITS);
+  }
+  result.strip();
+  return result;
+}
+
+//  the value of the n digits at str, powers = radix_powers(radix, n) or
+//  empty when there are less than DC_FROM_STRING_THRESHOLD chunks
+big_integer big_integer::read_radix(char const* str, size_t n, unsigned radix,
+                                    std::vector<big_integer> const& powers) {
+  size_t digits = chunk_digits(radix);
+  size_t chunks = (n + digits - 1) / digits;
+  if (chunks < limbs::DC_FROM_STRING_THRESHOLD) {
+    //  every chunk is below BASE, so the value fits in chunks limbs
+    big_integer result;
+    result.assure_size(chunks);
+    digit_t* data = result.data.data();
+    size_t size = 0;
+    //  the first chunk takes the leftover digits, the others full ones
+    size_t len = n - (chunks - 1) * digits;
+    for (char const* end = str + n; str != end; len = digits) {
+      digit_t chunk = 0;
+      for (char const* stop = str + len; str != stop; str++) {
+        chunk = chunk * radix + digit_value(*str);
+      }
+      digit_t top = limbs::mul_1(data, data, size, chunk_value(radix));
+      top += limbs::add_1(data, data, size, chunk);
+      if (top != 0) {
+        data[size++] = top;
+      }
+    }
+    result.strip();
+    return result;
+  }
+  //  the low part is the largest power-of-two number of chunks below n
+  size_t level = 0;
+  while ((digits << (level + 1)) < n) {
+    level++;
+  }
+  size_t low = digits << level;
+  return read_radix(str, n - low, radix, powers) * powers[level]
+         + read_radix(str + n - low, low, radix, powers);
+}
+
+//  writes the digits of |a| in a radix that is a power of two, bits per
+//  digit, from the end of the n characters at out
+void big_integer::write_bits(big_integer const& a, unsigned bits, char* out,
+                             size_t n) {
+  //  the limbs of |a| are those of ~a + 1 for a negative a, formed as they
+  //  are read, so the magnitude is never stored
+  digit_t flip = a.sign;
+  digit_t carry = flip & 1;
+  size_t next = 0;
+  auto magnitude_limb = [&a, flip, &carry, &next] {
+    digit_t x = (a.digit_at(next++) ^ flip) + carry;
+    carry = carry != 0 && x == 0;
+    return x;
+  };
+  digit_t low = magnitude_limb();
+  digit_t high = magnitude_limb();
+  digit_t mask = (static_cast<digit_t>(1) << bits) - 1;
+  size_t pos = 0;
+  for (size_t i = n; i-- > 0; pos += bits) {
+    while (next - 2 < pos / DIGITS) {
+      low = high;
+      high = magnitude_limb();
+    }
+    overflow_t value = low | static_cast<overflow_t>(high) << DIGITS;
+    out[i] = RADIX_DIGITS[(value >> (pos % DIGITS)) & mask];
+  }
+}
+
+//  writes the digits of |a|, a with less than DC_TO_STRING_THRESHOLD limbs,
+//  without leading zeros so that they end at end, returns where they start
+char* big_integer::write_small(big_integer const& a, unsigned radix,
+                               char* end) {
+  //  one more limb for the magnitude of a negative a
+  digit_t t[limbs::DC_TO_STRING_THRESHOLD + 1];
+  std::copy(std::as_const(a.data).data(),
+            std::as_const(a.data).data() + a.size(), t);
+  size_t n = a.size();
+  if (a.is_negative()) {
+    t[n++] = a.sign;
+    for (size_t i = 0; i != n; i++) {
+      t[i] = ~t[i];
+    }
+    limbs::add_1(t, t, n, 1);
+    while (n != 0 && t[n - 1] == 0) {
+      n--;
+    }
+  }
+  size_t digits = chunk_digits(radix);
+  digit_t chunk = chunk_value(radix);
+  do {
+    digit_t r = n == 0 ? 0 : limbs::divrem_1(t, t, n, chunk);
+    n -= n != 0 && t[n - 1] == 0;
+    for (size_t i = 0; i != digits && (n != 0 || r != 0 || i == 0);
+         i++, r /= radix) {
+      *--end = RADIX_DIGITS[r % radix];
+    }
+  } while (n != 0);
+  return end;
+}
+
+//  writes a < powers[level] as exactly chunk_digits(radix) * 2^level digits
+//  with leading zeros, splitting it by the powers below
+void big_integer::write_radix(big_integer const& a, unsigned radix,
+                              std::vector<big_integer> const& powers,
+                              size_t level, char* out) {
+  size_t width = chunk_digits(radix) << level;
+  if (level == 0 || a.size() < limbs::DC_TO_STRING_THRESHOLD) {
+    std::fill(out, write_small(a, radix, out + width), '0');
+    return;
+  }
+  auto qr = divmod(a, powers[level - 1]);
+  write_radix(qr.first, radix, powers, level - 1, out);
+  write_radix(qr.second, radix, powers, level - 1, out + width / 2);
 }
 
 std::string to_string(big_integer a) {
+  return to_string(a, 10);
+}
+
+std::string to_string(big_integer a, unsigned radix) {
+  check_radix(radix);
   bool negative = a.is_negative();
   a = a.abs();
   std::string result;
-  big_integer r;
-  do {
-    std::tie(a, r) = divmod(a, 10);
-    result += static_cast<char>('0' + r.digit_at(0));
-  } while (a != 0);
+  unsigned bits = radix_bits(radix);
+  if (bits != 0) {
+    result.assign(std::max<size_t>((a.bit_length() + bits - 1) / bits, 1),
+                  '0');
+    big_integer::write_bits(a, bits, &result[0], result.size());
+  } else {
+    std::vector<big_integer> powers = radix_powers(radix, 0);
+    while (powers.back() <= a) {
+      powers.push_back(sqr(powers.back()));
+    }
+    result.assign(chunk_digits(radix) << (powers.size() - 1), '0');
+    big_integer::write_radix(a, radix, powers, powers.size() - 1,
+                             &result[0]);
+    size_t start = std::min(result.find_first_not_of('0'),
+                            result.size() - 1);
+    result.erase(0, start);
+  }
   if (negative) {
-    result += '-';
+    result.insert(result.begin(), '-');
+  }
+  return result;
+}
+
+size_t digits_upper_bound(big_integer const& a, int base) {
+  check_radix(static_cast<unsigned>(base));
+  //  the magnitude of a negative number may need one more bit
+  size_t bits = a.is_negative() ? a.size() * DIGITS + 1 : a.bit_length();
+  return static_cast<size_t>(static_cast<double>(bits) / std::log2(base))
+         + 3;
+}
+
+std::to_chars_result to_chars(char* first, char* last,
+                              big_integer const& value, int base) {
+  unsigned radix = static_cast<unsigned>(base);
+  check_radix(radix);
+  size_t sign = value.is_negative() ? 1 : 0;
+  size_t space = static_cast<size_t>(last - first);
+  if (radix_bits(radix) != 0) {
+    unsigned bits = radix_bits(radix);
+    size_t n = std::max<size_t>((value.magnitude_bits() + bits - 1) / bits,
+                                1);
+    if (sign + n > space) {
+      return {last, std::errc::value_too_large};
+    }
+    std::fill(first, first + sign, '-');
+    big_integer::write_bits(value, bits, first + sign, n);
+    return {first + sign + n, std::errc()};
+  }
+  //  a magnitude of bits bits has more than (bits - 1) / log2(base) digits,
+  //  so a buffer short of that is turned down before any division
+  size_t bits = value.magnitude_bits();
+  if (bits != 0 && sign + static_cast<size_t>(
+          static_cast<double>(bits - 1) / std::log2(base)) > space) {
+    return {last, std::errc::value_too_large};
+  }
+  if (value.size() < limbs::DC_TO_STRING_THRESHOLD
+      && digits_upper_bound(value, base) <= space) {
+    char* start = big_integer::write_small(value, radix, last);
+    std::fill(start - sign, start, '-');
+    return {std::copy(start - sign, last, first), std::errc()};
+  }
+  std::string str = to_string(value, radix);
+  if (str.size() > space) {
+    return {last, std::errc::value_too_large};
+  }
+  return {std::copy(str.begin(), str.end(), first), std::errc()};
+}
+
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  big_integer& value, int base) {
+  unsigned radix = static_cast<unsigned>(base);
+  check_radix(radix);
+  char const* digits = first != last && *first == '-' ? first + 1 : first;
+  char const* end = digits;
+  while (end != last && digit_value(*end) < radix) {
+    end++;
+  }
+  if (end == digits) {
+    return {first, std::errc::invalid_argument};
+  }
+  value = big_integer::read_digits(digits, static_cast<size_t>(end - digits),
+                                   radix);
+  if (digits != first) {
+    value = -value;
+  }
+  return {end, std::errc()};
+}
+
+std::ostream& operator<<(std::ostream& out, big_integer const& a) {
+  char buf[64];
+  if (digits_upper_bound(a) <= sizeof(buf)) {
+    std::to_chars_result result = to_chars(buf, buf + sizeof(buf), a);
+    return out.write(buf, result.ptr - buf);
   }
-  return {result.rbegin(), result.rend()};
+  return out << to_string(a);
 }
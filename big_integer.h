@@ -3,35 +3,41 @@
 #ifndef BIG_INTEGER_H_
 #define BIG_INTEGER_H_
 
+#include <charconv>
+#include <ostream>
 #include <string>
-#include <functional>
 #include <limits>
 #include <utility>
+#include <vector>
 
 #include "./my_vector.cpp"
-
-using digit_t = uint32_t;
-using overflow_t = uint64_t;
-
-digit_t const MAX_DIGIT = std::numeric_limits<digit_t>::max();
-unsigned const DIGITS = std::numeric_limits<digit_t>::digits;
-overflow_t const BASE = static_cast<overflow_t>(MAX_DIGIT) + 1;
+#include "./limbs.h"
 
 struct big_integer {
   big_integer();
 
   big_integer(big_integer const& other) = default;
 
-  big_integer(digit_t a);
+  big_integer(big_integer&& other) noexcept = default;
+
+  //  fixed-width overloads, so that unsigned arguments pick the same one
+  //  whatever the width of the limbs
+  big_integer(uint32_t a);
+
+  big_integer(uint64_t a);
 
   big_integer(int a);
 
   explicit big_integer(std::string const& str);
 
+  explicit big_integer(std::string const& str, unsigned radix);
+
   ~big_integer() = default;
 
   big_integer& operator=(big_integer const& other) = default;
 
+  big_integer& operator=(big_integer&& other) noexcept = default;
+
   big_integer& operator+=(big_integer const& rhs);
 
   big_integer& operator-=(big_integer const& rhs);
@@ -41,13 +47,18 @@ struct big_integer {
 
   big_integer& operator*=(big_integer const& rhs);
 
+  //  *this += a * b and *this -= a * b without forming the product when
+  //  it is short
+  big_integer& addmul(big_integer const& a, big_integer const& b);
+
+  big_integer& submul(big_integer const& a, big_integer const& b);
+
   big_integer& operator/=(big_integer const& rhs);
 
   big_integer& operator%=(big_integer const& rhs);
 
-  big_integer& apply_bitwise_op(big_integer const& rhs,
-                                std::function<digit_t(digit_t,
-                                                      digit_t)> const& op);
+  template <typename Op>
+  big_integer& apply_bitwise_op(big_integer const& rhs, Op op);
 
   big_integer& operator&=(big_integer const& rhs);
 
@@ -89,32 +100,74 @@ struct big_integer {
 
   friend big_integer operator+(big_integer a, big_integer const& b);
 
+  friend big_integer operator+(big_integer const& a, big_integer&& b);
+
+  friend big_integer operator+(big_integer&& a, big_integer&& b);
+
   friend big_integer operator-(big_integer a, big_integer const& b);
 
-  friend big_integer operator*(big_integer a, big_integer b);
+  friend big_integer operator-(big_integer const& a, big_integer&& b);
+
+  friend big_integer operator-(big_integer&& a, big_integer&& b);
+
+  friend big_integer operator*(big_integer const& a, big_integer const& b);
+
+  friend big_integer sqr(big_integer const& a);
 
   friend std::pair<big_integer, big_integer>
   divmod(big_integer a, big_integer b);
 
+  friend std::pair<big_integer, digit_t>
+  divmod_small(big_integer a, digit_t b);
+
+  friend big_integer reciprocal(big_integer const& a, size_t precision);
+
+  friend big_integer mulmod(big_integer const& a, big_integer const& b,
+                            big_integer const& m);
+
+  template <typename Expr>
+  friend big_integer evaluate(Expr const& expr);
+
   friend big_integer operator/(big_integer const& a, big_integer const& b);
 
   friend big_integer operator%(big_integer const& a, big_integer const& b);
 
   friend big_integer operator&(big_integer a, big_integer const& b);
 
+  friend big_integer operator&(big_integer const& a, big_integer&& b);
+
+  friend big_integer operator&(big_integer&& a, big_integer&& b);
+
   friend big_integer operator|(big_integer a, big_integer const& b);
 
+  friend big_integer operator|(big_integer const& a, big_integer&& b);
+
+  friend big_integer operator|(big_integer&& a, big_integer&& b);
+
   friend big_integer operator^(big_integer a, big_integer const& b);
 
+  friend big_integer operator^(big_integer const& a, big_integer&& b);
+
+  friend big_integer operator^(big_integer&& a, big_integer&& b);
+
   friend big_integer operator<<(big_integer a, int b);
 
   friend big_integer operator>>(big_integer a, int b);
 
   friend std::string to_string(big_integer a);
 
-  friend std::ostream& operator<<(std::ostream& out, big_integer const& a) {
-    return out << to_string(a);
-  }
+  friend std::string to_string(big_integer a, unsigned radix);
+
+  friend size_t digits_upper_bound(big_integer const& a, int base);
+
+  friend std::to_chars_result to_chars(char* first, char* last,
+                                       big_integer const& value, int base);
+
+  friend std::from_chars_result from_chars(char const* first,
+                                           char const* last,
+                                           big_integer& value, int base);
+
+  friend std::ostream& operator<<(std::ostream& out, big_integer const& a);
 
  private:
   digit_t sign;
@@ -132,7 +185,63 @@ struct big_integer {
 
   bool is_negative() const;
 
-  friend big_integer multiply_by_digit(big_integer const& a, digit_t b);
+  big_integer& negate();
+
+  big_integer& accumulate_product(big_integer const& a, big_integer const& b,
+                                  bool subtract);
+
+  size_t bit_length() const;
+
+  //  bit_length of |*this|, without forming it
+  size_t magnitude_bits() const;
+
+  static big_integer approx_reciprocal(big_integer const& d, size_t n);
+
+  static std::pair<big_integer, big_integer>
+  newton_step(big_integer const& a, big_integer const& b,
+              big_integer const& x, size_t n);
+
+  static std::pair<big_integer, big_integer>
+  newton_divmod(big_integer const& a, big_integer const& b);
+
+  static big_integer read_digits(char const* str, size_t n, unsigned radix);
+
+  static big_integer read_bits(char const* str, size_t n, unsigned bits);
+
+  static big_integer read_radix(char const* str, size_t n, unsigned radix,
+                                std::vector<big_integer> const& powers);
+
+  static void write_bits(big_integer const& a, unsigned bits, char* out,
+                         size_t n);
+
+  static char* write_small(big_integer const& a, unsigned radix, char* end);
+
+  static void write_radix(big_integer const& a, unsigned radix,
+                          std::vector<big_integer> const& powers,
+                          size_t level, char* out);
 };
 
+big_integer sqr(big_integer const& a);
+
+std::pair<big_integer, digit_t> divmod_small(big_integer a, digit_t b);
+
+big_integer reciprocal(big_integer const& a, size_t precision);
+
+//  a * b % m with the sign of a * b, like the two operators
+big_integer mulmod(big_integer const& a, big_integer const& b,
+                   big_integer const& m);
+
+std::string to_string(big_integer a, unsigned radix);
+
+//  at least the number of characters to_chars writes for a, sign included
+size_t digits_upper_bound(big_integer const& a, int base = 10);
+
+std::to_chars_result to_chars(char* first, char* last,
+                              big_integer const& value, int base = 10);
+
+//  like std::from_chars: an optional minus and then the longest run of
+//  digits in base; value is left as is if there are none
+std::from_chars_result from_chars(char const* first, char const* last,
+                                  big_integer& value, int base = 10);
+
 #endif  // BIG_INTEGER_H_
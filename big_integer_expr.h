@@ -0,0 +1,188 @@
+//  Copyright 2019 Nikita Golikov
+
+#ifndef BIG_INTEGER_EXPR_H_
+#define BIG_INTEGER_EXPR_H_
+
+#include <algorithm>
+#include <type_traits>
+
+#include "./big_integer.h"
+
+//  opt-in deferred arithmetic: lazy(a) * b + lazy(c) * d - e is evaluated
+//  into one result that is allocated once and accumulated with addmul and
+//  submul, r += lazy(a) * b is r.addmul(a, b) and lazy(a) * b % m is
+//  mulmod(a, b, m); expressions refer to their operands, so they must not
+//  outlive the full expression that builds them
+
+struct lazy_term {
+  big_integer const& value;
+
+  template <typename F>
+  void visit(F const& f, bool subtract) const {
+    f(value, nullptr, subtract);
+  }
+
+  operator big_integer() const {
+    return value;
+  }
+};
+
+struct lazy_product {
+  big_integer const& a;
+  big_integer const& b;
+
+  template <typename F>
+  void visit(F const& f, bool subtract) const {
+    f(a, &b, subtract);
+  }
+
+  operator big_integer() const {
+    return a * b;
+  }
+};
+
+template <typename L, typename R>
+struct lazy_sum {
+  L left;
+  R right;
+  bool subtract;
+
+  template <typename F>
+  void visit(F const& f, bool negate) const {
+    left.visit(f, negate);
+    right.visit(f, negate != subtract);
+  }
+
+  operator big_integer() const {
+    return evaluate(*this);
+  }
+};
+
+template <typename T>
+struct is_lazy : std::false_type {};
+
+template <>
+struct is_lazy<lazy_term> : std::true_type {};
+
+template <>
+struct is_lazy<lazy_product> : std::true_type {};
+
+template <typename L, typename R>
+struct is_lazy<lazy_sum<L, R>> : std::true_type {};
+
+template <typename T>
+using if_lazy = std::enable_if_t<is_lazy<T>::value, int>;
+
+inline lazy_term lazy(big_integer const& a) {
+  return {a};
+}
+
+inline lazy_product operator*(lazy_term a, big_integer const& b) {
+  return {a.value, b};
+}
+
+inline lazy_product operator*(lazy_term a, lazy_term b) {
+  return {a.value, b.value};
+}
+
+template <typename L, typename R, if_lazy<L> = 0, if_lazy<R> = 0>
+lazy_sum<L, R> operator+(L const& a, R const& b) {
+  return {a, b, false};
+}
+
+template <typename L, typename R, if_lazy<L> = 0, if_lazy<R> = 0>
+lazy_sum<L, R> operator-(L const& a, R const& b) {
+  return {a, b, true};
+}
+
+template <typename L, if_lazy<L> = 0>
+lazy_sum<L, lazy_term> operator+(L const& a, big_integer const& b) {
+  return {a, lazy(b), false};
+}
+
+template <typename L, if_lazy<L> = 0>
+lazy_sum<L, lazy_term> operator-(L const& a, big_integer const& b) {
+  return {a, lazy(b), true};
+}
+
+template <typename R, if_lazy<R> = 0>
+lazy_sum<lazy_term, R> operator+(big_integer const& a, R const& b) {
+  return {lazy(a), b, false};
+}
+
+template <typename R, if_lazy<R> = 0>
+lazy_sum<lazy_term, R> operator-(big_integer const& a, R const& b) {
+  return {lazy(a), b, true};
+}
+
+template <typename Expr>
+big_integer evaluate(Expr const& expr) {
+  //  every term grows the result by at most a limb over the longest one
+  size_t bound = 1;
+  expr.visit([&bound](big_integer const& a, big_integer const* b, bool) {
+    bound = std::max(bound, a.size() + (b == nullptr ? 0 : b->size())) + 1;
+  }, false);
+  big_integer result;
+  result.assure_size(bound);
+  result.strip();
+  expr.visit([&result](big_integer const& a, big_integer const* b,
+                       bool subtract) {
+    if (b != nullptr) {
+      result.accumulate_product(a, *b, subtract);
+    } else if (subtract) {
+      result -= a;
+    } else {
+      result += a;
+    }
+  }, false);
+  return result;
+}
+
+template <typename Expr>
+bool refers_to(Expr const& expr, big_integer const& r) {
+  bool found = false;
+  expr.visit([&found, &r](big_integer const& a, big_integer const* b, bool) {
+    found = found || &a == &r || b == &r;
+  }, false);
+  return found;
+}
+
+//  terms are accumulated into r one by one, so an expression that reads r
+//  itself is evaluated apart first
+template <typename Expr, if_lazy<Expr> = 0>
+big_integer& operator+=(big_integer& r, Expr const& expr) {
+  if (refers_to(expr, r)) {
+    return r += evaluate(expr);
+  }
+  expr.visit([&r](big_integer const& a, big_integer const* b,
+                  bool subtract) {
+    if (b == nullptr) {
+      subtract ? r -= a : r += a;
+    } else {
+      subtract ? r.submul(a, *b) : r.addmul(a, *b);
+    }
+  }, false);
+  return r;
+}
+
+template <typename Expr, if_lazy<Expr> = 0>
+big_integer& operator-=(big_integer& r, Expr const& expr) {
+  if (refers_to(expr, r)) {
+    return r -= evaluate(expr);
+  }
+  expr.visit([&r](big_integer const& a, big_integer const* b,
+                  bool subtract) {
+    if (b == nullptr) {
+      subtract ? r += a : r -= a;
+    } else {
+      subtract ? r.addmul(a, *b) : r.submul(a, *b);
+    }
+  }, false);
+  return r;
+}
+
+inline big_integer operator%(lazy_product p, big_integer const& m) {
+  return mulmod(p.a, p.b, m);
+}
+
+#endif  // BIG_INTEGER_EXPR_H_
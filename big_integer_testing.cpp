@@ -1,11 +1,14 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
 
 #include "big_integer.h"
+#include "big_integer_expr.h"
 
 TEST(correctness, two_plus_two)
 {
@@ -734,4 +737,706 @@ ASSERT_EQ(divident - quotient * divisor, residue);
 EXPECT_GE(residue, 0);
 EXPECT_LT(residue, divisor);
 }
-}
\ No newline at end of file
+}
+namespace
+{
+  //  a * b through products by narrow slices of b, each one below every
+  //  multiplication threshold, so it only exercises the basecase
+  big_integer mul_by_slices(big_integer const& a, big_integer b, int bits)
+  {
+    big_integer mask = (big_integer(1) << bits) - 1;
+    big_integer result = 0;
+    for (int shift = 0; b != 0; shift += bits, b >>= bits)
+      result += (a * (b & mask)) << shift;
+    return result;
+  }
+}
+
+TEST(correctness, mul_karatsuba)
+{
+for (size_t itn = 0; itn != number_of_iterations; ++itn)
+{
+big_integer a = rand_big(100 + 30 * itn);
+big_integer b = rand_big(60 + 40 * itn);
+big_integer expected = mul_by_slices(a, b, 512);
+EXPECT_EQ(a * b, expected);
+EXPECT_EQ(b * a, expected);
+EXPECT_EQ((-a) * b, -expected);
+EXPECT_EQ(a * a, mul_by_slices(a, a, 512));
+}
+}
+
+TEST(correctness, mul_toom)
+{
+for (size_t itn = 0; itn != 4; ++itn)
+{
+big_integer a = rand_big(250 + 150 * itn);
+big_integer b = rand_big(220 + 160 * itn);
+big_integer expected = mul_by_slices(a, b, 512);
+EXPECT_EQ(a * b, expected);
+EXPECT_EQ(a * (-b), -expected);
+}
+}
+
+TEST(correctness, mul_ntt)
+{
+big_integer a = rand_big(2400);
+big_integer b = rand_big(2100);
+big_integer expected = mul_by_slices(a, b, 512);
+EXPECT_EQ(a * b, expected);
+EXPECT_EQ((-a) * (-b), expected);
+
+big_integer ones = (big_integer(1) << 70000) - 1;
+EXPECT_EQ(ones * ones, mul_by_slices(ones, ones, 512));
+}
+
+TEST(correctness, sqr)
+{
+EXPECT_EQ(sqr(0), 0);
+EXPECT_EQ(sqr(-3), 9);
+for (size_t itn = 0; itn != number_of_iterations; ++itn)
+{
+big_integer a = rand_big(10 + 90 * itn);
+big_integer expected = mul_by_slices(a, a, 512);
+EXPECT_EQ(sqr(a), expected);
+EXPECT_EQ(sqr(-a), expected);
+EXPECT_EQ(a * a, expected);
+}
+}
+
+TEST(correctness, mul_unbalanced)
+{
+big_integer a = rand_big(3000);
+for (size_t n : {40, 250, 700})
+{
+big_integer b = rand_big(n);
+big_integer expected = mul_by_slices(b, a, 512);
+EXPECT_EQ(a * b, expected);
+EXPECT_EQ(b * a, expected);
+}
+}
+
+TEST(correctness, div_long_recursive)
+{
+big_integer a = rand_big(3000);
+for (size_t n : {50, 400, 1500, 2900})
+{
+big_integer b = rand_big(n);
+big_integer q = a / b;
+big_integer r = a % b;
+EXPECT_EQ(q * b + r, a);
+EXPECT_GE(r, 0);
+EXPECT_LT(r, b);
+EXPECT_EQ((-a) / b, -q);
+EXPECT_EQ((-a) % b, -r);
+}
+}
+
+TEST(correctness, div_newton)
+{
+big_integer a = rand_big(14000);
+for (size_t n : {4200, 6000, 9000})
+{
+big_integer b = rand_big(n);
+big_integer q = a / b;
+big_integer r = a % b;
+EXPECT_EQ(q * b + r, a);
+EXPECT_GE(r, 0);
+EXPECT_LT(r, b);
+EXPECT_EQ(a / (-b), -q);
+EXPECT_EQ((-a) % b, -r);
+}
+}
+
+TEST(correctness, div_long_quotient)
+{
+big_integer b = rand_big(4200);
+big_integer q = 0;
+for (int i = 0; i != 10; ++i)
+{
+q = (q << 130000) + rand_big(4200);
+}
+big_integer r = b - rand_big(100);
+for (big_integer const& c : {q, (big_integer(1) << 1300000) - 1})
+{
+big_integer a = c * b + r;
+EXPECT_EQ(a / b, c);
+EXPECT_EQ(a % b, r);
+EXPECT_EQ((-a) / b, -c);
+EXPECT_EQ((-a) % b, -r);
+}
+}
+
+TEST(correctness, div_short_quotient)
+{
+for (size_t n : {3990, 4200, 20000})
+{
+big_integer b = rand_big(n);
+big_integer a = b * 1000003 + 77;
+EXPECT_EQ(a / b, 1000003);
+EXPECT_EQ(a % b, 77);
+EXPECT_EQ((-a) / b, -1000003);
+EXPECT_EQ(a % (-b), 77);
+big_integer c = (b << 5000) + 5;
+EXPECT_EQ(c / b, big_integer(1) << 5000);
+EXPECT_EQ(c % b, 5);
+}
+}
+
+TEST(correctness, reciprocal)
+{
+EXPECT_EQ(reciprocal(3, 10), 341);
+EXPECT_EQ(reciprocal(-3, 10), -341);
+EXPECT_THROW(reciprocal(0, 10), std::invalid_argument);
+big_integer b = rand_big(4500);
+big_integer one = big_integer(1) << 600000;
+big_integer x = reciprocal(b, 600000);
+EXPECT_LE(x * b, one);
+EXPECT_GT((x + 1) * b, one);
+}
+
+TEST(correctness, divmod_small)
+{
+EXPECT_THROW(divmod_small(5, 0), std::invalid_argument);
+EXPECT_EQ(divmod_small(0, 7).first, 0);
+EXPECT_EQ(divmod_small(-23, 7).first, -3);
+EXPECT_EQ(divmod_small(-23, 7).second, 2u);
+for (size_t itn = 0; itn != number_of_iterations; ++itn)
+{
+big_integer a = rand_big(5 + 20 * itn);
+for (digit_t d : std::vector<digit_t>{1, 10, 1000000000,
+                                      MAX_DIGIT / 2 + 1, MAX_DIGIT})
+{
+std::pair<big_integer, digit_t> qr = divmod_small(a, d);
+EXPECT_EQ(qr.first * d + qr.second, a);
+EXPECT_LT(qr.second, d);
+EXPECT_EQ(a / d, qr.first);
+EXPECT_EQ((-a) % d, -big_integer(qr.second));
+}
+}
+}
+
+TEST(correctness, to_string_long)
+{
+EXPECT_EQ(to_string(big_integer(1000000000)), "1000000000");
+EXPECT_EQ(to_string(big_integer(-999999999)), "-999999999");
+std::string nines(3000, '9');
+EXPECT_EQ(to_string(big_integer(nines)), nines);
+std::string power = "1" + std::string(2500, '0');
+EXPECT_EQ(to_string(-big_integer(power)), "-" + power);
+std::string digits;
+for (size_t i = 0; i != 4000; ++i)
+{
+digits += static_cast<char>('0' + (i * 7 + i / 13) % 10);
+}
+digits[0] = '4';
+EXPECT_EQ(to_string(big_integer(digits)), digits);
+}
+
+TEST(correctness, from_string_long)
+{
+EXPECT_EQ(big_integer("-"), 0);
+EXPECT_EQ(big_integer("+000000000000000000042"), 42);
+EXPECT_THROW(big_integer(std::string(500, '1') + "x"), std::invalid_argument);
+std::string digits = "3";
+for (size_t i = 1; i != 5000; ++i)
+{
+digits += static_cast<char>('0' + (i * i + 3) % 10);
+}
+big_integer expected = 0;
+for (char c : digits)
+{
+expected = expected * 10 + (c - '0');
+}
+EXPECT_EQ(big_integer(digits), expected);
+EXPECT_EQ(big_integer("-" + digits), -expected);
+EXPECT_EQ(big_integer(std::string(700, '0') + digits), expected);
+}
+
+TEST(correctness, radix_conversion)
+{
+EXPECT_EQ(to_string(big_integer(255), 16), "ff");
+EXPECT_EQ(to_string(big_integer(-8), 2), "-1000");
+EXPECT_EQ(to_string(big_integer(0), 36), "0");
+EXPECT_EQ(big_integer("-DeadBeef", 16), -big_integer(3735928559u));
+EXPECT_EQ(big_integer("zz", 36), 1295);
+EXPECT_THROW(big_integer("12", 1), std::invalid_argument);
+EXPECT_THROW(big_integer("19", 8), std::invalid_argument);
+EXPECT_THROW(to_string(big_integer(1), 37), std::invalid_argument);
+
+big_integer a = rand_big(300);
+for (unsigned radix : {2u, 3u, 7u, 8u, 10u, 16u, 32u, 36u})
+{
+EXPECT_EQ(big_integer(to_string(a, radix), radix), a);
+EXPECT_EQ(big_integer(to_string(-a, radix), radix), -a);
+}
+EXPECT_EQ(to_string(a, 10), to_string(a));
+}
+
+TEST(correctness, to_from_chars)
+{
+char buf[32];
+std::to_chars_result res = to_chars(buf, buf + sizeof(buf), big_integer(-1234));
+EXPECT_EQ(res.ec, std::errc());
+EXPECT_EQ(std::string(buf, res.ptr), "-1234");
+res = to_chars(buf, buf + 4, big_integer(-1234));
+EXPECT_EQ(res.ec, std::errc::value_too_large);
+res = to_chars(buf, buf + sizeof(buf), big_integer(0), 16);
+EXPECT_EQ(std::string(buf, res.ptr), "0");
+
+big_integer a = rand_big(100);
+std::vector<char> big(digits_upper_bound(-a, 7));
+res = to_chars(big.data(), big.data() + big.size(), -a, 7);
+EXPECT_EQ(res.ec, std::errc());
+EXPECT_EQ(std::string(big.data(), res.ptr), to_string(-a, 7));
+
+big_integer v = 5;
+std::string s = "-ff0g";
+std::from_chars_result parsed = from_chars(s.data(), s.data() + s.size(), v, 16);
+EXPECT_EQ(parsed.ec, std::errc());
+EXPECT_EQ(parsed.ptr, s.data() + 4);
+EXPECT_EQ(v, -0xff0);
+s = "-x";
+parsed = from_chars(s.data(), s.data() + s.size(), v);
+EXPECT_EQ(parsed.ec, std::errc::invalid_argument);
+EXPECT_EQ(parsed.ptr, s.data());
+EXPECT_EQ(v, -0xff0);
+s = to_string(a);
+from_chars(s.data(), s.data() + s.size(), v);
+EXPECT_EQ(v, a);
+
+big_integer huge = rand_big(3000);
+res = to_chars(buf, buf + sizeof(buf), -huge);
+EXPECT_EQ(res.ec, std::errc::value_too_large);
+for (big_integer const& x : {big_integer(-1234), a, -huge})
+{
+std::ostringstream out;
+out << x;
+EXPECT_EQ(out.str(), to_string(x));
+}
+}
+
+TEST(correctness, move_semantics)
+{
+big_integer a = rand_big(50);
+big_integer copy = a;
+big_integer b = std::move(a);
+EXPECT_EQ(b, copy);
+a = 7;
+EXPECT_EQ(a, 7);
+a = std::move(b);
+EXPECT_EQ(a, copy);
+b = -3;
+b += a;
+EXPECT_EQ(b, copy - 3);
+big_integer c = std::move(a) + b;
+EXPECT_EQ(c, copy + copy - 3);
+a = c;
+c = std::move(c);
+EXPECT_EQ(c, a);
+}
+
+TEST(correctness, rvalue_operators)
+{
+big_integer a = rand_big(40);
+big_integer b = rand_big(25);
+big_integer c = rand_big(30);
+EXPECT_EQ(a + (b * c), (b * c) + a);
+EXPECT_EQ(a - (b * c), -((b * c) - a));
+EXPECT_EQ((a * b) - (b * c), b * (a - c));
+EXPECT_EQ(a - big_integer(-1), a + 1);
+EXPECT_EQ(-1 - a, -(a + 1));
+EXPECT_EQ((a & (b * c)) | (a ^ (b * c)), a | (b * c));
+EXPECT_EQ((-a) ^ (b + c), (c + b) ^ (-a));
+EXPECT_EQ(big_integer(-1) * a, -a);
+EXPECT_EQ(a * big_integer(-1) * big_integer(0), 0);
+}
+
+TEST(correctness, fused_arithmetic)
+{
+big_integer a = rand_big(60);
+big_integer b = -rand_big(45);
+big_integer c = rand_big(3);
+big_integer d = rand_big(50);
+
+big_integer r = d;
+r.addmul(a, b);
+EXPECT_EQ(r, d + a * b);
+r.submul(a, b);
+EXPECT_EQ(r, d);
+r.submul(c, c);
+EXPECT_EQ(r, d - c * c);
+r = 5;
+r.addmul(r, r);
+EXPECT_EQ(r, 30);
+
+r = c;
+r += lazy(a) * b;
+EXPECT_EQ(r, c + a * b);
+r -= lazy(a) * b - lazy(c) * d;
+EXPECT_EQ(r, c + c * d);
+
+big_integer s = lazy(a) * b + lazy(c) * d - a;
+EXPECT_EQ(s, a * b + c * d - a);
+big_integer t = d - lazy(a) * a;
+EXPECT_EQ(t, d - a * a);
+big_integer big = rand_big(200);
+big_integer u = lazy(big) * big - lazy(big) * big;
+EXPECT_EQ(u, 0);
+
+r = 10;
+big_integer x = 3;
+big_integer y = 4;
+r += lazy(x) * y + lazy(r);
+EXPECT_EQ(r, 32);
+t = 10;
+t += lazy(y) * x - lazy(t) * x;
+EXPECT_EQ(t, -8);
+r = d;
+r -= lazy(a) * b - lazy(r) * c;
+EXPECT_EQ(r, d - a * b + d * c);
+
+EXPECT_EQ(mulmod(a, b, d), a * b % d);
+EXPECT_EQ(mulmod(b, a, -c), b * a % c);
+EXPECT_EQ(lazy(a) * d % c, a * d % c);
+EXPECT_EQ(mulmod(c, c, big), c * c);
+EXPECT_EQ(mulmod(big, big, a), big * big % a);
+EXPECT_THROW(mulmod(a, b, 0), std::invalid_argument);
+}
+
+TEST(correctness, my_vector_inline)
+{
+my_vector<int, 3> v(1);
+v.push_back(2);
+v.push_front(0);
+EXPECT_EQ(v.size(), 3u);
+EXPECT_EQ(v.capacity(), 3u);
+v.push_back(3);
+EXPECT_EQ(v[0], 0);
+EXPECT_EQ(v.back(), 3);
+my_vector<int, 3> copy = v;
+#ifndef BIGINT_NO_COW
+EXPECT_TRUE(copy.shares_storage(v));
+#endif
+copy.pop_front(2);
+EXPECT_EQ(copy.size(), 2u);
+EXPECT_EQ(copy[0], 2);
+EXPECT_EQ(v[2], 2);
+
+my_vector<int, 3> w(5);
+w.push_front(4, 2);
+EXPECT_EQ(w[0], 4);
+EXPECT_EQ(w[2], 5);
+w.pop_front(1);
+w.resize(3, 7);
+EXPECT_EQ(w[2], 7);
+w.pop_back();
+my_vector<int, 3> x(4);
+x.push_back(5);
+EXPECT_TRUE(w == x);
+}
+
+TEST(correctness, values_up_to_128_bits)
+{
+big_integer a = (big_integer(1) << 127) - 1;
+big_integer b = (big_integer(1) << 64) + 3;
+EXPECT_EQ(to_string(a), "170141183460469231731687303715884105727");
+EXPECT_EQ((a - b) + b, a);
+EXPECT_EQ(a / b * b + a % b, a);
+EXPECT_EQ((a >> 64) << 64, a - (a & ((big_integer(1) << 64) - 1)));
+EXPECT_EQ(-a - 1, -(big_integer(1) << 127));
+}
+
+TEST(correctness, shared_values_across_threads)
+{
+big_integer const shared = rand_big(200);
+big_integer const expected = shared * 3 + 1;
+std::vector<std::thread> workers;
+std::vector<int> ok(4, 0);
+for (size_t t = 0; t != ok.size(); ++t)
+{
+workers.emplace_back([&shared, &expected, &ok, t]
+{
+bool all = true;
+for (int itn = 0; itn != 200; ++itn)
+{
+big_integer copy = shared;
+copy *= 3;
+copy += 1;
+big_integer again = copy;
+again -= 1;
+all = all && copy == expected && again == shared * 3;
+}
+ok[t] = all;
+});
+}
+for (std::thread& worker : workers)
+{
+worker.join();
+}
+for (int result : ok)
+{
+EXPECT_TRUE(result);
+}
+EXPECT_EQ(shared * 3 + 1, expected);
+}
+
+TEST(correctness, limb_shifts_share_buffer)
+{
+big_integer a = rand_big(300);
+big_integer b = a;
+b >>= 320;
+EXPECT_EQ(b, a / (big_integer(1) << 320));
+b <<= 320;
+EXPECT_EQ(b, a - a % (big_integer(1) << 320));
+big_integer c = a;
+for (int i = 0; i != 100; ++i)
+{
+c <<= 32;
+}
+for (int i = 0; i != 100; ++i)
+{
+c >>= 32;
+}
+EXPECT_EQ(c, a);
+c >>= 31;
+c <<= 31;
+EXPECT_EQ(c, a >> 31 << 31);
+EXPECT_EQ(a, b + a % (big_integer(1) << 320));
+
+my_vector<int, 2> v(1);
+for (int i = 2; i != 10; ++i)
+{
+v.push_back(i);
+}
+my_vector<int, 2> w = v;
+w.pop_front(3);
+w.push_front(0, 5);
+EXPECT_EQ(w.size(), 11u);
+EXPECT_EQ(w[4], 0);
+EXPECT_EQ(w[5], 4);
+EXPECT_EQ(v[0], 1);
+EXPECT_EQ(v.size(), 9u);
+}
+
+TEST(correctness, carry_chains)
+{
+for (int n : {1, 3, 4, 5, 17, 100})
+{
+big_integer p = big_integer(1) << (32 * n);
+big_integer ones = p - 1;
+EXPECT_EQ(ones + 1, p);
+EXPECT_EQ(p - 1 - ones, 0);
+EXPECT_EQ(-ones - 1, -p);
+EXPECT_EQ(-p + 1, -ones);
+EXPECT_EQ(ones + ones, (p << 1) - 2);
+EXPECT_EQ(-ones - ones, 2 - (p << 1));
+}
+for (int itn = 0; itn != 200; ++itn)
+{
+big_integer a = rand_big(1 + itn % 40);
+big_integer b = rand_big(1 + itn % 7);
+for (int i = 0; i != 4; ++i)
+{
+big_integer x = i & 1 ? -a : a;
+big_integer y = i & 2 ? -b : b;
+EXPECT_EQ(x + y - y, x);
+EXPECT_EQ(y + x - x, y);
+EXPECT_EQ(x - y + y, x);
+EXPECT_EQ(y - x, -(x - y));
+}
+}
+}
+
+TEST(correctness, kernel_dispatch)
+{
+std::string best = limbs::kernels();
+EXPECT_FALSE(limbs::use_kernels("no such kernels"));
+EXPECT_EQ(limbs::kernels(), best);
+
+std::vector<big_integer> values;
+for (size_t i = 0; i != 12; ++i)
+{
+values.push_back(rand_big(1 + 9 * i));
+}
+values.push_back((big_integer(1) << 1000) - 1);
+auto results = [&values]
+{
+std::vector<big_integer> r;
+for (big_integer const& a : values)
+{
+for (big_integer const& b : values)
+{
+r.push_back(a * b);
+r.push_back(a + b);
+r.push_back(a - b);
+r.push_back(a / b);
+r.push_back(a & b);
+r.push_back(a ^ b);
+}
+r.push_back(a << 37);
+r.push_back(a >> 37);
+}
+return r;
+};
+ASSERT_TRUE(limbs::use_kernels("generic"));
+std::vector<big_integer> expected = results();
+for (char const* name : {"bmi2", "avx2", "avx512"})
+{
+if (limbs::use_kernels(name))
+{
+EXPECT_TRUE(results() == expected) << name;
+std::vector<digit_t> a(37), b(37), r(37);
+for (size_t i = 0; i != a.size(); ++i)
+{
+a[i] = static_cast<digit_t>(i * 2654435761u);
+b[i] = ~static_cast<digit_t>(i * 40503u);
+}
+limbs::xor_n(r.data(), a.data(), b.data(), r.size());
+limbs::and_n(r.data(), r.data(), a.data(), r.size());
+for (size_t i = 0; i != r.size(); ++i)
+{
+EXPECT_EQ(r[i], (a[i] ^ b[i]) & a[i]) << name;
+}
+std::vector<digit_t> ones(37, MAX_DIGIT);
+r = ones;
+EXPECT_EQ(limbs::addmul_1(r.data(), ones.data(), r.size(),
+                          MAX_DIGIT), MAX_DIGIT) << name;
+EXPECT_EQ(r[0], 0u) << name;
+for (size_t i = 1; i != r.size(); ++i)
+{
+EXPECT_EQ(r[i], MAX_DIGIT) << name;
+}
+}
+}
+EXPECT_TRUE(limbs::use_kernels(best.c_str()));
+}
+
+TEST(correctness, bitwise_long)
+{
+for (int itn = 0; itn != 100; ++itn)
+{
+big_integer a = rand_big(1 + itn % 50);
+big_integer b = rand_big(1 + itn % 13);
+for (int i = 0; i != 4; ++i)
+{
+big_integer x = i & 1 ? -a : a;
+big_integer y = i & 2 ? -b : b;
+EXPECT_EQ((x & y) + (x | y), x + y);
+EXPECT_EQ(x ^ y, (x | y) - (x & y));
+EXPECT_EQ(~(x & y), ~x | ~y);
+EXPECT_EQ(y ^ x ^ y, x);
+}
+}
+}
+
+TEST(correctness, shifts_any_count)
+{
+std::string best = limbs::kernels();
+for (char const* name : {"generic", "bmi2", "avx2", "avx512"})
+{
+if (!limbs::use_kernels(name))
+{
+continue;
+}
+for (size_t len : {1, 2, 7, 8, 9, 16, 17, 33, 70})
+{
+big_integer a = rand_big(len);
+for (int s : {1, 5, 31, 32, 33, 63, 64, 65, 130, 517})
+{
+big_integer p = big_integer(1) << s;
+EXPECT_EQ(a << s, a * p) << name;
+EXPECT_EQ((a >> s) << s, a - (a & (p - 1))) << name;
+EXPECT_EQ((-a >> s) << s, -a - (-a & (p - 1))) << name;
+big_integer b = a;
+b <<= s;
+b >>= s;
+EXPECT_EQ(b, a) << name;
+}
+}
+}
+EXPECT_TRUE(limbs::use_kernels(best.c_str()));
+}
+
+TEST(correctness, to_chars_negative_in_place)
+{
+std::vector<big_integer> values;
+for (int bits : {31, 32, 33, 64, 127, 128, 160, 200, 640})
+{
+big_integer p = big_integer(1) << bits;
+values.push_back(-p);
+values.push_back(-p + 1);
+values.push_back(-p - 1);
+values.push_back(-(p / 3));
+}
+values.push_back(-1);
+for (big_integer const& v : values)
+{
+for (int base : {2, 7, 10, 16, 32, 36})
+{
+std::vector<char> buf(digits_upper_bound(v, base));
+std::to_chars_result res = to_chars(buf.data(), buf.data() + buf.size(), v, base);
+EXPECT_EQ(res.ec, std::errc());
+EXPECT_EQ(std::string(buf.data(), res.ptr), to_string(v, base));
+std::string exact = to_string(v, base);
+res = to_chars(buf.data(), buf.data() + exact.size(), v, base);
+EXPECT_EQ(std::string(buf.data(), res.ptr), exact);
+res = to_chars(buf.data(), buf.data() + exact.size() - 1, v, base);
+EXPECT_EQ(res.ec, std::errc::value_too_large);
+}
+}
+}
+
+TEST(correctness, product_with_shifted_view)
+{
+big_integer x = (big_integer(1) << 200) + 12345;
+EXPECT_EQ(x * (x >> 320), 0);
+EXPECT_EQ((-x) * ((-x) >> 320), x);
+big_integer y = rand_big(20);
+big_integer z = y >> 64;
+EXPECT_EQ(y * z, y * (z + 1) - y);
+EXPECT_EQ(z * y, y * z);
+
+my_vector<int, 2> v(1);
+for (int i = 2; i != 10; ++i)
+{
+v.push_back(i);
+}
+my_vector<int, 2> w = v;
+w.pop_front(2);
+EXPECT_FALSE(w.shares_storage(v));
+my_vector<int, 2> u = v;
+u.pop_back();
+EXPECT_FALSE(u.shares_storage(v));
+w.pop_front(w.size());
+EXPECT_TRUE(w.empty());
+EXPECT_FALSE(w.shares_storage(v));
+}
+
+TEST(correctness, fixed_width_constructors)
+{
+uint32_t small = 4000000000u;
+uint64_t wide = 18446744073709551615ull;
+EXPECT_EQ(to_string(big_integer(small)), "4000000000");
+EXPECT_EQ(to_string(big_integer(wide)), "18446744073709551615");
+EXPECT_EQ(big_integer(uint64_t(1) << 40), big_integer(1) << 40);
+EXPECT_EQ(big_integer(uint64_t(0)), 0);
+EXPECT_EQ(big_integer(wide) + 1, big_integer(1) << 64);
+EXPECT_EQ(big_integer(3735928559u) - big_integer(small), -264071441);
+}
+
+TEST(correctness, product_with_value_shifted_out)
+{
+big_integer x = (big_integer(1) << 200) + 12345;
+EXPECT_EQ(x * (x >> 300), 0);
+EXPECT_EQ(x * (x >> 201), 0);
+EXPECT_EQ(x * (x >> 200), x);
+EXPECT_EQ((-x) * ((-x) >> 300), x);
+EXPECT_EQ((-x) * ((-x) >> 201), x);
+big_integer y = rand_big(30);
+for (int s : {1, 33, 500, 959, 960, 961, 2000})
+{
+big_integer z = y >> s;
+EXPECT_EQ(y * z, y * (z + 1) - y);
+}
+}
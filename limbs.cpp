@@ -0,0 +1,807 @@
+//  Copyright 2019 Nikita Golikov
+
+#include "./limbs.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+namespace limbs {
+
+static_assert(KARATSUBA_THRESHOLD >= 2, "karatsuba needs two-limb halves");
+
+namespace {
+
+inline digit_t lo(overflow_t x) {
+  return static_cast<digit_t>(x);
+}
+
+inline digit_t hi(overflow_t x) {
+  return static_cast<digit_t>(x >> DIGITS);
+}
+
+//  r[0..an) = |a[0..an) - b[0..bn)|, an >= bn, returns whether a < b
+bool abs_diff(digit_t* r, digit_t const* a, size_t an,
+              digit_t const* b, size_t bn) {
+  size_t top = an;
+  while (top > bn && a[top - 1] == 0) {
+    top--;
+  }
+  bool less = top == bn && cmp(a, b, bn) < 0;
+  if (less) {
+    sub_n(r, b, a, bn);
+    std::fill(r + bn, r + an, 0);
+  } else {
+    digit_t borrow = sub_n(r, a, b, bn);
+    sub_1(r + bn, a + bn, an - bn, borrow);
+  }
+  return less;
+}
+
+//  uninitialized temporary limbs
+std::unique_ptr<digit_t[]> scratch_limbs(size_t n) {
+  return std::unique_ptr<digit_t[]>(new digit_t[n]);
+}
+
+//  enough for every level of the recursion below on operands of n limbs
+size_t karatsuba_scratch_size(size_t n) {
+  return 4 * n + 5 * std::numeric_limits<size_t>::digits;
+}
+
+void mul_karatsuba(digit_t* r, digit_t const* a, size_t an,
+                   digit_t const* b, size_t bn, digit_t* scratch);
+
+//  r[0..n) holds z0 at 0 and z2 at 2h, adds z0 + z2 -+ p at h, which is
+//  exactly a0 * b1 + a1 * b0; t is 2h + 1 limbs of scratch
+void karatsuba_middle(digit_t* r, size_t n, size_t h, digit_t const* p,
+                      digit_t* t, bool add) {
+  std::copy(r, r + 2 * h, t);
+  t[2 * h] = 0;
+  digit_t carry = add_n(t, t, r + 2 * h, n - 2 * h);
+  add_1(t + n - 2 * h, t + n - 2 * h, 4 * h + 1 - n, carry);
+  if (add) {
+    t[2 * h] += add_n(t, t, p, 2 * h);
+  } else {
+    t[2 * h] -= sub_n(t, t, p, 2 * h);
+  }
+  size_t tn = std::min(2 * h + 1, n - h);
+  carry = add_n(r + h, r + h, t, tn);
+  add_1(r + h + tn, r + h + tn, n - h - tn, carry);
+}
+
+void mul_rec(digit_t* r, digit_t const* a, size_t an,
+             digit_t const* b, size_t bn, digit_t* scratch) {
+  if (an < bn) {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+  if (bn < KARATSUBA_THRESHOLD) {
+    mul_basecase(r, a, an, b, bn);
+  } else {
+    mul_karatsuba(r, a, an, b, bn, scratch);
+  }
+}
+
+//  a = a1 * B^h + a0, b = b1 * B^h + b0,
+//  a * b = z2 * B^2h + (z0 + z2 - (a0 - a1)(b0 - b1)) * B^h + z0
+void mul_karatsuba(digit_t* r, digit_t const* a, size_t an,
+                   digit_t const* b, size_t bn, digit_t* scratch) {
+  size_t h = (an + 1) / 2;
+  size_t n = an + bn;
+  if (bn <= h) {
+    //  b has no high half: a * b = (a1 * b) * B^h + a0 * b
+    digit_t* t = scratch;
+    size_t tn = an - h + bn;
+    mul_rec(r, a, h, b, bn, scratch + tn);
+    mul_rec(t, a + h, an - h, b, bn, scratch + tn);
+    digit_t carry = add_n(r + h, r + h, t, bn);
+    add_1(r + h + bn, t + bn, tn - bn, carry);
+    return;
+  }
+  size_t a1n = an - h;
+  size_t b1n = bn - h;
+  digit_t* p = scratch;
+  digit_t* t = scratch + 2 * h;
+  digit_t* next = scratch + 4 * h + 1;
+
+  digit_t* da = t;
+  digit_t* db = t + h;
+  bool sign = abs_diff(da, a, h, a + h, a1n);
+  sign ^= abs_diff(db, b, h, b + h, b1n);
+  mul_rec(p, da, h, db, h, next);
+  mul_rec(r, a, h, b, h, next);
+  mul_rec(r + 2 * h, a + h, a1n, b + h, b1n, next);
+  karatsuba_middle(r, n, h, p, t, sign);
+}
+
+void sqr_rec(digit_t* r, digit_t const* a, size_t n, digit_t* scratch);
+
+//  the same with a0 - a1 squared, so the middle term is always subtracted
+void sqr_karatsuba(digit_t* r, digit_t const* a, size_t n,
+                   digit_t* scratch) {
+  size_t h = (n + 1) / 2;
+  digit_t* p = scratch;
+  digit_t* t = scratch + 2 * h;
+  digit_t* next = scratch + 4 * h + 1;
+  abs_diff(t, a, h, a + h, n - h);
+  sqr_rec(p, t, h, next);
+  sqr_rec(r, a, h, next);
+  sqr_rec(r + 2 * h, a + h, n - h, next);
+  karatsuba_middle(r, 2 * n, h, p, t, false);
+}
+
+void sqr_rec(digit_t* r, digit_t const* a, size_t n, digit_t* scratch) {
+  if (n < KARATSUBA_THRESHOLD) {
+    sqr_basecase(r, a, n);
+  } else {
+    sqr_karatsuba(r, a, n, scratch);
+  }
+}
+
+//  Toom-Cook below keeps signed intermediate values as two's complement
+//  numbers of a fixed number of limbs
+
+bool is_negative(digit_t const* a, size_t n) {
+  return (a[n - 1] >> (DIGITS - 1)) != 0;
+}
+
+void negate(digit_t* a, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    a[i] = ~a[i];
+  }
+  add_1(a, a, n, 1);
+}
+
+//  r[0..n) = a[0..n) * x modulo B^n, r may be equal to a
+void mul_small(digit_t* r, digit_t const* a, size_t n, int x) {
+  mul_1(r, a, n, static_cast<digit_t>(x < 0 ? -x : x));
+  if (x < 0) {
+    negate(r, n);
+  }
+}
+
+//  a[0..n) -= b[0..n) * x modulo B^n, t is n limbs of scratch
+void submul_small(digit_t* a, digit_t const* b, size_t n, int x,
+                  digit_t* t) {
+  if (x != 0) {
+    mul_small(t, b, n, x);
+    sub_n(a, a, t, n);
+  }
+}
+
+//  a[0..n) /= x, the division must be exact
+void divexact_small(digit_t* a, size_t n, int x) {
+  bool negative = x < 0;
+  digit_t d = static_cast<digit_t>(negative ? -x : x);
+  unsigned shift = 0;
+  for (; d % 2 == 0; d /= 2) {
+    shift++;
+  }
+  if (d != 1) {
+    //  division by an odd number is a multiplication by its inverse
+    digit_t inv = d;
+    for (int i = 0; i < 5; i++) {
+      inv *= 2 - d * inv;
+    }
+    digit_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+      digit_t s = a[i] - borrow;
+      digit_t under = a[i] < borrow;
+      a[i] = s * inv;
+      borrow = hi(static_cast<overflow_t>(a[i]) * d) + under;
+    }
+  }
+  if (shift != 0) {
+    digit_t fill = is_negative(a, n) ? MAX_DIGIT : 0;
+    for (size_t i = 0; i < n; i++) {
+      digit_t next = i + 1 < n ? a[i + 1] : fill;
+      a[i] = (a[i] >> shift) | (next << (DIGITS - shift));
+    }
+  }
+  if (negative) {
+    negate(a, n);
+  }
+}
+
+//  finite evaluation points of Toom-k, infinity is used as well
+int const TOOM_POINTS[] = {0, 1, -1, 2, -2, 3};
+
+//  r[0..k + 2) = a(x), where a[0..an) is split into parts pieces of k limbs
+void toom_eval(digit_t* r, digit_t const* a, size_t an, size_t k,
+               size_t parts, int x) {
+  std::fill(r, r + k + 2, 0);
+  for (size_t i = parts; i-- > 0;) {
+    mul_small(r, r, k + 2, x);
+    if (i * k < an) {
+      size_t len = std::min(k, an - i * k);
+      digit_t carry = add_n(r, r, a + i * k, len);
+      add_1(r + len, r + len, k + 2 - len, carry);
+    }
+  }
+}
+
+//  whether every operand has a non-empty top piece when split into parts
+bool toom_fits(size_t an, size_t bn, size_t parts) {
+  size_t k = (an + parts - 1) / parts;
+  return bn > (parts - 1) * k;
+}
+
+//  multiplies polynomials with parts coefficients of k limbs by evaluating
+//  them at 2 * parts - 1 points and interpolating through Newton's divided
+//  differences; every division on the way is exact
+void mul_toom(digit_t* r, digit_t const* a, size_t an,
+              digit_t const* b, size_t bn, size_t parts) {
+  bool square = a == b && an == bn;
+  size_t k = (an + parts - 1) / parts;
+  size_t points = 2 * parts - 2;
+  size_t w = 2 * k + 3;
+  size_t top = (parts - 1) * k;
+  std::unique_ptr<digit_t[]> buf = scratch_limbs(points * w + 2 * (k + 2)
+                                                 + 2 * w);
+  digit_t* ea = buf.get() + points * w;
+  digit_t* eb = ea + k + 2;
+  digit_t* c = eb + k + 2;
+  digit_t* t = c + w;
+  auto v = [&buf, w](size_t i) {
+    return buf.get() + i * w;
+  };
+
+  for (size_t i = 0; i < points; i++) {
+    toom_eval(ea, a, an, k, parts, TOOM_POINTS[i]);
+    if (square) {
+      if (is_negative(ea, k + 2)) {
+        negate(ea, k + 2);
+      }
+      sqr(v(i), ea, k + 1);
+      v(i)[w - 1] = 0;
+      continue;
+    }
+    toom_eval(eb, b, bn, k, parts, TOOM_POINTS[i]);
+    bool negative = is_negative(ea, k + 2) != is_negative(eb, k + 2);
+    if (is_negative(ea, k + 2)) {
+      negate(ea, k + 2);
+    }
+    if (is_negative(eb, k + 2)) {
+      negate(eb, k + 2);
+    }
+    mul(v(i), ea, k + 1, eb, k + 1);
+    v(i)[w - 1] = 0;
+    if (negative) {
+      negate(v(i), w);
+    }
+  }
+
+  //  the leading coefficient is the product of the top pieces,
+  //  its contribution is removed from every point
+  digit_t* inf = r + points * k;
+  size_t inf_n = an + bn - 2 * top;
+  if (square) {
+    sqr(inf, a + top, an - top);
+  } else {
+    mul(inf, a + top, an - top, b + top, bn - top);
+  }
+  std::copy(inf, inf + inf_n, c);
+  std::fill(c + inf_n, c + w, 0);
+  for (size_t i = 0; i < points; i++) {
+    int power = 1;
+    for (size_t j = 0; j < points; j++) {
+      power *= TOOM_POINTS[i];
+    }
+    submul_small(v(i), c, w, power, t);
+  }
+
+  for (size_t j = 1; j < points; j++) {
+    for (size_t i = points - 1; i >= j; i--) {
+      sub_n(v(i), v(i), v(i - 1), w);
+      divexact_small(v(i), w, TOOM_POINTS[i] - TOOM_POINTS[i - j]);
+    }
+  }
+  for (size_t i = points - 1; i-- > 0;) {
+    for (size_t j = i; j + 1 < points; j++) {
+      submul_small(v(j), v(j + 1), w, TOOM_POINTS[i], t);
+    }
+  }
+
+  //  the leading coefficient is already in place
+  size_t n = an + bn;
+  std::fill(r, inf, 0);
+  for (size_t i = 0; i < points; i++) {
+    size_t len = std::min(w, n - i * k);
+    digit_t carry = add_n(r + i * k, r + i * k, v(i), len);
+    add_1(r + i * k + len, r + i * k + len, n - i * k - len, carry);
+  }
+}
+
+//  number-theoretic transforms modulo three primes p = c * 2^k + 1 below
+//  2^31, the product is recovered through the chinese remainder theorem;
+//  operands are cut into 32-bit pieces, so every coefficient of the
+//  product stays below p1 * p2 * p3 for transforms up to 2^26 points
+
+unsigned const NTT_PIECE_BITS = 32;
+size_t const NTT_PIECES = DIGITS / NTT_PIECE_BITS;
+size_t const NTT_MAX_SIZE = size_t(1) << 26;
+
+uint32_t ntt_piece(digit_t const* a, size_t i) {
+  return static_cast<uint32_t>(a[i / NTT_PIECES] >>
+                               (NTT_PIECE_BITS * (i % NTT_PIECES)));
+}
+
+constexpr uint32_t pow_mod(uint32_t a, uint64_t e, uint32_t p) {
+  uint64_t result = 1;
+  for (uint64_t x = a; e != 0; e /= 2, x = x * x % p) {
+    if (e % 2 != 0) {
+      result = result * x % p;
+    }
+  }
+  return static_cast<uint32_t>(result);
+}
+
+//  Montgomery arithmetic modulo P with R = 2^32, G is a primitive root
+template <uint32_t P, uint32_t G>
+struct ntt_field {
+  static uint32_t const MOD = P;
+
+  static constexpr uint32_t neg_inverse() {
+    uint32_t inv = P;
+    for (int i = 0; i < 5; i++) {
+      inv *= 2 - P * inv;
+    }
+    return -inv;
+  }
+
+  static uint32_t const NEG_INV = neg_inverse();
+  static uint32_t const R2 = pow_mod(2, 64, P);
+
+  static uint32_t reduce(uint64_t x) {
+    uint32_t m = static_cast<uint32_t>(x) * NEG_INV;
+    uint32_t t = static_cast<uint32_t>((x + static_cast<uint64_t>(m) * P)
+                                       >> 32);
+    return t >= P ? t - P : t;
+  }
+
+  //  a * b / R
+  static uint32_t mul(uint32_t a, uint32_t b) {
+    return reduce(static_cast<uint64_t>(a) * b);
+  }
+
+  static uint32_t add(uint32_t a, uint32_t b) {
+    uint32_t s = a + b;
+    return s >= P ? s - P : s;
+  }
+
+  static uint32_t sub(uint32_t a, uint32_t b) {
+    return a >= b ? a - b : a + P - b;
+  }
+
+  //  roots[len + j] = w^j * R for every power of two len < n,
+  //  where w is a root of unity of order 2 * len
+  static void roots(uint32_t* r, size_t n) {
+    for (size_t len = 1; len < n; len *= 2) {
+      uint32_t w = mul(pow_mod(G, (P - 1) / (2 * len), P), R2);
+      r[len] = mul(1, R2);
+      for (size_t j = 1; j < len; j++) {
+        r[len + j] = mul(r[len + j - 1], w);
+      }
+    }
+  }
+
+  //  decimation in frequency, the result is in bit-reversed order
+  static void forward(uint32_t* a, size_t n, uint32_t const* r) {
+    for (size_t len = n / 2; len >= 1; len /= 2) {
+      for (size_t i = 0; i < n; i += 2 * len) {
+        for (size_t j = 0; j < len; j++) {
+          uint32_t u = a[i + j];
+          uint32_t v = a[i + j + len];
+          a[i + j] = add(u, v);
+          a[i + j + len] = mul(sub(u, v), r[len + j]);
+        }
+      }
+    }
+  }
+
+  //  decimation in time from bit-reversed order, scaled by n,
+  //  w^-j is taken as -w^(len - j)
+  static void inverse(uint32_t* a, size_t n, uint32_t const* r) {
+    for (size_t len = 1; len < n; len *= 2) {
+      for (size_t i = 0; i < n; i += 2 * len) {
+        uint32_t u = a[i];
+        uint32_t v = a[i + len];
+        a[i] = add(u, v);
+        a[i + len] = sub(u, v);
+        for (size_t j = 1; j < len; j++) {
+          u = a[i + j];
+          v = mul(a[i + j + len], r[2 * len - j]);
+          a[i + j] = sub(u, v);
+          a[i + j + len] = add(u, v);
+        }
+      }
+    }
+  }
+
+  //  fa[0..n) = residues of the cyclic convolution of the pieces,
+  //  fb[0..n) and r[0..n) are used as scratch
+  static void convolve(uint32_t* fa, uint32_t* fb, uint32_t* r, size_t n,
+                       digit_t const* a, size_t an, digit_t const* b,
+                       size_t bn) {
+    bool square = a == b && an == bn;
+    for (size_t i = 0; i < n; i++) {
+      fa[i] = i < an ? ntt_piece(a, i) % P : 0;
+    }
+    roots(r, n);
+    forward(fa, n, r);
+    if (square) {
+      std::copy(fa, fa + n, fb);
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        fb[i] = i < bn ? ntt_piece(b, i) % P : 0;
+      }
+      forward(fb, n, r);
+    }
+    for (size_t i = 0; i < n; i++) {
+      fa[i] = mul(fa[i], fb[i]);
+    }
+    inverse(fa, n, r);
+    //  pointwise products brought R^-1, the transforms brought n
+    uint32_t scale = mul(mul(pow_mod(static_cast<uint32_t>(n % P), P - 2, P),
+                             R2), R2);
+    for (size_t i = 0; i < n; i++) {
+      fa[i] = mul(fa[i], scale);
+    }
+  }
+};
+
+using ntt_field1 = ntt_field<469762049, 3>;
+using ntt_field2 = ntt_field<1811939329, 13>;
+using ntt_field3 = ntt_field<2013265921, 31>;
+
+bool ntt_fits(size_t an, size_t bn) {
+  return (an + bn) * NTT_PIECES <= NTT_MAX_SIZE;
+}
+
+void mul_ntt(digit_t* r, digit_t const* a, size_t an,
+             digit_t const* b, size_t bn) {
+  size_t pa = an * NTT_PIECES;
+  size_t pb = bn * NTT_PIECES;
+  size_t n = 1;
+  while (n < pa + pb - 1) {
+    n *= 2;
+  }
+  std::unique_ptr<uint32_t[]> buf(new uint32_t[5 * n]);
+  uint32_t* r1 = buf.get();
+  uint32_t* r2 = r1 + n;
+  uint32_t* r3 = r2 + n;
+  uint32_t* fb = r3 + n;
+  uint32_t* roots = fb + n;
+  ntt_field1::convolve(r1, fb, roots, n, a, pa, b, pb);
+  ntt_field2::convolve(r2, fb, roots, n, a, pa, b, pb);
+  ntt_field3::convolve(r3, fb, roots, n, a, pa, b, pb);
+
+  uint64_t const p1 = ntt_field1::MOD;
+  uint64_t const p2 = ntt_field2::MOD;
+  uint64_t const p3 = ntt_field3::MOD;
+  uint64_t const p12 = p1 * p2;
+  uint64_t const inv1 = pow_mod(static_cast<uint32_t>(p1 % p2), p2 - 2,
+                                static_cast<uint32_t>(p2));
+  uint64_t const inv12 = pow_mod(static_cast<uint32_t>(p12 % p3), p3 - 2,
+                                 static_cast<uint32_t>(p3));
+
+  //  the running sum of coefficients fits into three 32-bit words
+  uint64_t low = 0;
+  uint64_t high = 0;
+  std::fill(r, r + an + bn, 0);
+  for (size_t i = 0; i < pa + pb; i++) {
+    if (i + 1 < pa + pb) {
+      uint64_t x2 = (r2[i] + p2 - r1[i]) * inv1 % p2;
+      uint64_t x12 = r1[i] + p1 * x2;
+      uint64_t x3 = (r3[i] + p3 - x12 % p3) * inv12 % p3;
+      //  x12 + p12 * x3
+      uint64_t mid = (p12 & 0xffffffff) * x3 + (x12 & 0xffffffff);
+      low += mid & 0xffffffff;
+      high += (p12 >> 32) * x3 + (mid >> 32) + (x12 >> 32);
+    }
+    r[i / NTT_PIECES] |= static_cast<digit_t>(low & 0xffffffff)
+                         << (NTT_PIECE_BITS * (i % NTT_PIECES));
+    low = (low >> 32) + (high & 0xffffffff);
+    high >>= 32;
+  }
+}
+
+//  a is cut into pieces of bn limbs, so that every product a_i * b is
+//  square-sized and runs on the best balanced algorithm
+void mul_unbalanced(digit_t* r, digit_t const* a, size_t an,
+                    digit_t const* b, size_t bn) {
+  std::unique_ptr<digit_t[]> t = scratch_limbs(2 * bn);
+  mul(r, a, bn, b, bn);
+  for (size_t i = bn; i < an; i += bn) {
+    size_t len = std::min(bn, an - i);
+    mul(t.get(), a + i, len, b, bn);
+    digit_t carry = add_n(r + i, r + i, t.get(), bn);
+    add_1(r + i + bn, t.get() + bn, len, carry);
+  }
+}
+
+//  divides the dn + k limbs at a by d, k <= dn, like divrem_basecase;
+//  the quotient is estimated from the top k limbs of d and corrected
+//  with one multiplication, tp is dn limbs of scratch
+digit_t divrem_block(digit_t* q, digit_t* a, digit_t const* d, size_t dn,
+                     size_t k, digit_t* tp) {
+  if (k < DC_DIV_THRESHOLD) {
+    return divrem_basecase(q, a, dn + k, d, dn);
+  }
+  if (k == dn) {
+    size_t lo = k / 2;
+    digit_t qh = divrem_block(q + lo, a + lo, d, dn, k - lo, tp);
+    divrem_block(q, a, d, dn, lo, tp);
+    return qh;
+  }
+  digit_t qh = divrem_block(q, a + dn - k, d + dn - k, k, k, tp);
+  mul(tp, q, k, d, dn - k);
+  digit_t borrow = sub_n(a, a, tp, dn);
+  if (qh != 0) {
+    borrow += sub_n(a + k, a + k, d, dn - k);
+  }
+  while (borrow != 0) {
+    qh -= sub_1(q, q, k, 1);
+    borrow -= add_n(a, a, d, dn);
+  }
+  return qh;
+}
+
+}  // namespace
+
+digit_t add_1(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  size_t i = 0;
+  for (; i < n && b != 0; i++) {
+    r[i] = a[i] + b;
+    b = r[i] < b;
+  }
+  if (r != a) {
+    std::copy(a + i, a + n, r + i);
+  }
+  return b;
+}
+
+digit_t sub_1(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  size_t i = 0;
+  for (; i < n && b != 0; i++) {
+    digit_t x = a[i];
+    r[i] = x - b;
+    b = x < b;
+  }
+  if (r != a) {
+    std::copy(a + i, a + n, r + i);
+  }
+  return b;
+}
+
+int cmp(digit_t const* a, digit_t const* b, size_t n) {
+  for (size_t i = n; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+unsigned leading_zeros(digit_t x) {
+  unsigned result = 0;
+  for (; (x >> (DIGITS - 1)) == 0; x <<= 1) {
+    result++;
+  }
+  return result;
+}
+
+void sqr_basecase(digit_t* r, digit_t const* a, size_t n) {
+  //  every product a[i] * a[j] with i < j is computed once
+  r[0] = 0;
+  r[n] = mul_1(r + 1, a + 1, n - 1, a[0]);
+  for (size_t i = 1; i < n; i++) {
+    r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+  }
+  //  then doubled, with the squares of single limbs on the diagonal
+  digit_t shifted = 0;
+  digit_t carry = 0;
+  for (size_t i = 0; i < 2 * n; i++) {
+    overflow_t square = static_cast<overflow_t>(a[i / 2]) * a[i / 2];
+    overflow_t t = static_cast<overflow_t>((r[i] << 1) | shifted) + carry
+                   + (i % 2 == 0 ? lo(square) : hi(square));
+    shifted = r[i] >> (DIGITS - 1);
+    r[i] = lo(t);
+    carry = hi(t);
+  }
+}
+
+void sqr(digit_t* r, digit_t const* a, size_t n) {
+  if (n < KARATSUBA_THRESHOLD) {
+    sqr_basecase(r, a, n);
+  } else if (n >= NTT_THRESHOLD && ntt_fits(n, n)) {
+    mul_ntt(r, a, n, a, n);
+  } else if (n >= TOOM4_THRESHOLD && toom_fits(n, n, 4)) {
+    mul_toom(r, a, n, a, n, 4);
+  } else if (n >= TOOM3_THRESHOLD && toom_fits(n, n, 3)) {
+    mul_toom(r, a, n, a, n, 3);
+  } else {
+    //  also the few short lengths whose top toom piece would be empty
+    std::unique_ptr<digit_t[]> scratch = scratch_limbs(
+            karatsuba_scratch_size(n));
+    sqr_karatsuba(r, a, n, scratch.get());
+  }
+}
+
+void mul(digit_t* r, digit_t const* a, size_t an,
+         digit_t const* b, size_t bn) {
+  if (a == b && an == bn) {
+    sqr(r, a, an);
+    return;
+  }
+  if (an < bn) {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+  if (bn < KARATSUBA_THRESHOLD) {
+    mul_basecase(r, a, an, b, bn);
+  } else if (bn >= NTT_THRESHOLD && ntt_fits(an, bn)) {
+    //  the transform length follows an + bn, so imbalance costs nothing
+    mul_ntt(r, a, an, b, bn);
+  } else if (an >= 2 * bn
+             || (bn >= TOOM3_THRESHOLD && an > bn
+                 && !toom_fits(an, bn, 3))) {
+    mul_unbalanced(r, a, an, b, bn);
+  } else if (bn < TOOM3_THRESHOLD || !toom_fits(an, bn, 3)) {
+    //  equal lengths too short for toom with a tiny -D threshold as well
+    std::unique_ptr<digit_t[]> scratch = scratch_limbs(
+            karatsuba_scratch_size(an));
+    mul_karatsuba(r, a, an, b, bn, scratch.get());
+  } else if (bn >= TOOM4_THRESHOLD && toom_fits(an, bn, 4)) {
+    mul_toom(r, a, an, b, bn, 4);
+  } else {
+    mul_toom(r, a, an, b, bn, 3);
+  }
+}
+
+digit_t addmul(digit_t* r, digit_t const* a, size_t an,
+               digit_t const* b, size_t bn) {
+  if (an < bn) {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+  if (bn >= KARATSUBA_THRESHOLD) {
+    std::unique_ptr<digit_t[]> p = scratch_limbs(an + bn);
+    mul(p.get(), a, an, b, bn);
+    return add_n(r, r, p.get(), an + bn);
+  }
+  //  rows go straight into r, so no product is formed
+  digit_t carry = 0;
+  for (size_t j = 0; j < bn; j++) {
+    digit_t high = addmul_1(r + j, a, an, b[j]);
+    carry += add_1(r + an + j, r + an + j, bn - j, high);
+  }
+  return carry;
+}
+
+digit_t submul(digit_t* r, digit_t const* a, size_t an,
+               digit_t const* b, size_t bn) {
+  if (an < bn) {
+    std::swap(a, b);
+    std::swap(an, bn);
+  }
+  if (bn >= KARATSUBA_THRESHOLD) {
+    std::unique_ptr<digit_t[]> p = scratch_limbs(an + bn);
+    mul(p.get(), a, an, b, bn);
+    return sub_n(r, r, p.get(), an + bn);
+  }
+  digit_t borrow = 0;
+  for (size_t j = 0; j < bn; j++) {
+    digit_t high = submul_1(r + j, a, an, b[j]);
+    borrow += sub_1(r + an + j, r + an + j, bn - j, high);
+  }
+  return borrow;
+}
+
+digit_t invert_limb(digit_t d) {
+  return lo(~(static_cast<overflow_t>(d) << DIGITS) / d);
+}
+
+digit_t divrem_1(digit_t* q, digit_t const* a, size_t n, digit_t d) {
+  unsigned shift = leading_zeros(d);
+  d <<= shift;
+  digit_t v = invert_limb(d);
+  digit_t r = 0;
+  for (size_t i = n; i-- > 0;) {
+    //  u is the next limb of a << shift and r < d the running remainder
+    digit_t u = a[i] << shift;
+    if (shift != 0 && i != 0) {
+      u |= a[i - 1] >> (DIGITS - shift);
+    }
+    if (shift != 0 && i + 1 == n) {
+      r = a[i] >> (DIGITS - shift);
+    }
+    overflow_t t = static_cast<overflow_t>(v) * r
+                   + ((static_cast<overflow_t>(r) << DIGITS) | u);
+    digit_t q1 = hi(t) + 1;
+    digit_t rem = u - q1 * d;
+    if (rem > lo(t)) {
+      q1--;
+      rem += d;
+    }
+    if (rem >= d) {
+      q1++;
+      rem -= d;
+    }
+    r = rem;
+    q[i] = q1;
+  }
+  return r >> shift;
+}
+
+digit_t divrem_basecase(digit_t* q, digit_t* a, size_t an,
+                        digit_t const* d, size_t dn) {
+  size_t qn = an - dn;
+  digit_t qh = cmp(a + qn, d, dn) >= 0;
+  if (qh != 0) {
+    sub_n(a + qn, a + qn, d, dn);
+  }
+  overflow_t d1 = d[dn - 1];
+  overflow_t d0 = dn > 1 ? d[dn - 2] : 0;
+  for (size_t j = qn; j-- > 0;) {
+    //  estimate from the top two limbs, then the third one
+    digit_t* aj = a + j;
+    overflow_t top = (static_cast<overflow_t>(aj[dn]) << DIGITS) | aj[dn - 1];
+    overflow_t next = dn > 1 ? aj[dn - 2] : 0;
+    overflow_t quo = aj[dn] >= d1 ? MAX_DIGIT : top / d1;
+    overflow_t rem = top - quo * d1;
+    while (rem < BASE && quo * d0 > ((rem << DIGITS) | next)) {
+      quo--;
+      rem += d1;
+    }
+    digit_t borrow = submul_1(aj, d, dn, lo(quo));
+    if (aj[dn] < borrow) {
+      quo--;
+      add_n(aj, aj, d, dn);
+    }
+    aj[dn] = 0;
+    q[j] = lo(quo);
+  }
+  return qh;
+}
+
+void divrem(digit_t* q, digit_t* r, digit_t const* a, size_t an,
+            digit_t const* d, size_t dn) {
+  unsigned shift = leading_zeros(d[dn - 1]);
+  //  short operands, the usual case, are divided without touching the heap
+  digit_t local[32];
+  std::unique_ptr<digit_t[]> buf;
+  size_t buf_size = an + 1 + 2 * dn;
+  digit_t* na = buf_size <= std::size(local)
+                ? local : (buf = scratch_limbs(buf_size)).get();
+  digit_t* nd = na + an + 1;
+  digit_t* tp = nd + dn;
+  if (shift != 0) {
+    na[an] = lshift(na, a, an, shift);
+    lshift(nd, d, dn, shift);
+  } else {
+    na[an] = 0;
+    std::copy(a, a + an, na);
+    std::copy(d, d + dn, nd);
+  }
+  //  the extra top limb is below nd[dn - 1], so no quotient bit is lost
+  size_t qn = an + 1 - dn;
+  if (dn < DC_DIV_THRESHOLD || qn < DC_DIV_THRESHOLD) {
+    divrem_basecase(q, na, an + 1, nd, dn);
+  } else {
+    size_t first = qn % dn == 0 ? dn : qn % dn;
+    size_t j = qn - first;
+    divrem_block(q + j, na + j, nd, dn, first, tp);
+    while (j > 0) {
+      j -= dn;
+      divrem_block(q + j, na + j, nd, dn, dn, tp);
+    }
+  }
+  if (shift != 0) {
+    rshift(r, na, dn, shift);
+  } else {
+    std::copy(na, na + dn, r);
+  }
+}
+
+}  // namespace limbs
@@ -0,0 +1,159 @@
+//  Copyright 2019 Nikita Golikov
+
+#ifndef LIMBS_H_
+#define LIMBS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+//  limbs are 32 bits wide unless BIGINT_LIMB64 asks for 64-bit limbs with
+//  128-bit intermediates, which needs unsigned __int128 from GCC or Clang
+#ifdef BIGINT_LIMB64
+using digit_t = uint64_t;
+__extension__ typedef unsigned __int128 overflow_t;
+#else
+using digit_t = uint32_t;
+using overflow_t = uint64_t;
+#endif
+
+digit_t const MAX_DIGIT = std::numeric_limits<digit_t>::max();
+unsigned const DIGITS = std::numeric_limits<digit_t>::digits;
+overflow_t const BASE = static_cast<overflow_t>(MAX_DIGIT) + 1;
+
+//  thresholds are in limbs of the shorter operand and can be tuned per host
+//  with -D on the compiler command line
+#ifndef BIGINT_KARATSUBA_THRESHOLD
+#define BIGINT_KARATSUBA_THRESHOLD 32
+#endif
+#ifndef BIGINT_TOOM3_THRESHOLD
+#define BIGINT_TOOM3_THRESHOLD 200
+#endif
+#ifndef BIGINT_TOOM4_THRESHOLD
+#define BIGINT_TOOM4_THRESHOLD 600
+#endif
+#ifndef BIGINT_DC_DIV_THRESHOLD
+#define BIGINT_DC_DIV_THRESHOLD 40
+#endif
+#ifndef BIGINT_NEWTON_DIV_THRESHOLD
+#define BIGINT_NEWTON_DIV_THRESHOLD 4000
+#endif
+#ifndef BIGINT_DC_TO_STRING_THRESHOLD
+#define BIGINT_DC_TO_STRING_THRESHOLD 30
+#endif
+#ifndef BIGINT_DC_FROM_STRING_THRESHOLD
+#define BIGINT_DC_FROM_STRING_THRESHOLD 30
+#endif
+#ifndef BIGINT_NTT_THRESHOLD
+#define BIGINT_NTT_THRESHOLD 2000
+#endif
+
+//  kernels working on raw little-endian arrays of limbs (magnitudes only);
+//  unless stated otherwise the result must not overlap the operands
+//
+//  the shifts, the bitwise kernels and, with 64-bit limbs, addmul_1 and
+//  mul_basecase come in versions for several x86-64 instruction sets, the
+//  best one this cpu runs is chosen at startup
+namespace limbs {
+
+size_t const KARATSUBA_THRESHOLD = BIGINT_KARATSUBA_THRESHOLD;
+size_t const TOOM3_THRESHOLD = BIGINT_TOOM3_THRESHOLD;
+size_t const TOOM4_THRESHOLD = BIGINT_TOOM4_THRESHOLD;
+size_t const NTT_THRESHOLD = BIGINT_NTT_THRESHOLD;
+size_t const DC_DIV_THRESHOLD = BIGINT_DC_DIV_THRESHOLD;
+size_t const NEWTON_DIV_THRESHOLD = BIGINT_NEWTON_DIV_THRESHOLD;
+size_t const DC_TO_STRING_THRESHOLD = BIGINT_DC_TO_STRING_THRESHOLD;
+size_t const DC_FROM_STRING_THRESHOLD = BIGINT_DC_FROM_STRING_THRESHOLD;
+
+//  r[0..n) = a[0..n) + b[0..n), returns carry; r may be equal to a or b
+digit_t add_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n);
+
+//  r[0..n) = a[0..n) - b[0..n), returns borrow; r may be equal to a or b
+digit_t sub_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n);
+
+//  r[0..n) = a[0..n) + b, returns carry; r may be equal to a
+digit_t add_1(digit_t* r, digit_t const* a, size_t n, digit_t b);
+
+//  r[0..n) = a[0..n) - b, returns borrow; r may be equal to a
+digit_t sub_1(digit_t* r, digit_t const* a, size_t n, digit_t b);
+
+//  r[0..n) = a[0..n) op b[0..n) limb by limb; r may be equal to a or b
+void and_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n);
+
+void ior_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n);
+
+void xor_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n);
+
+//  sign of a[0..n) - b[0..n)
+int cmp(digit_t const* a, digit_t const* b, size_t n);
+
+//  r[0..n) = a[0..n) * b, returns the high limb; r may be equal to a
+digit_t mul_1(digit_t* r, digit_t const* a, size_t n, digit_t b);
+
+//  r[0..n) += a[0..n) * b, returns the high limb
+digit_t addmul_1(digit_t* r, digit_t const* a, size_t n, digit_t b);
+
+//  r[0..n) -= a[0..n) * b, returns the borrowed high limb
+digit_t submul_1(digit_t* r, digit_t const* a, size_t n, digit_t b);
+
+//  r[0..an + bn) = a[0..an) * b[0..bn), quadratic, an >= bn >= 1
+void mul_basecase(digit_t* r, digit_t const* a, size_t an,
+                  digit_t const* b, size_t bn);
+
+//  r[0..n) = a[0..n) << shift, returns the bits shifted out,
+//  0 < shift < DIGITS; r may be equal to a
+digit_t lshift(digit_t* r, digit_t const* a, size_t n, unsigned shift);
+
+//  r[0..n) = a[0..n) >> shift, returns the bits shifted out at the top of
+//  a limb, 0 < shift < DIGITS; r may be equal to a
+digit_t rshift(digit_t* r, digit_t const* a, size_t n, unsigned shift);
+
+//  number of leading zero bits of a non-zero limb
+unsigned leading_zeros(digit_t x);
+
+//  r[0..2n) = a[0..n)^2, quadratic with about half of the products
+void sqr_basecase(digit_t* r, digit_t const* a, size_t n);
+
+//  r[0..2n) = a[0..n)^2, n >= 1
+void sqr(digit_t* r, digit_t const* a, size_t n);
+
+//  r[0..an + bn) = a[0..an) * b[0..bn), an, bn >= 1
+void mul(digit_t* r, digit_t const* a, size_t an,
+         digit_t const* b, size_t bn);
+
+//  r[0..an + bn) += a[0..an) * b[0..bn), returns the carry; an, bn >= 1
+digit_t addmul(digit_t* r, digit_t const* a, size_t an,
+               digit_t const* b, size_t bn);
+
+//  r[0..an + bn) -= a[0..an) * b[0..bn), returns the borrow; an, bn >= 1
+digit_t submul(digit_t* r, digit_t const* a, size_t an,
+               digit_t const* b, size_t bn);
+
+//  floor((BASE^2 - 1) / d) - BASE for a normalized d, that is with its highest
+//  bit set; lets divrem_1 divide by multiplications (Moller and Granlund)
+digit_t invert_limb(digit_t d);
+
+//  q[0..n) = a[0..n) / d, returns a[0..n) mod d, d != 0; q may be equal to a
+digit_t divrem_1(digit_t* q, digit_t const* a, size_t n, digit_t d);
+
+//  a[0..an) is replaced by the remainder in a[0..dn), q[0..an - dn) gets
+//  the quotient and its top bit is returned; d[0..dn) must be normalized,
+//  that is its highest bit set; schoolbook, an >= dn >= 1
+digit_t divrem_basecase(digit_t* q, digit_t* a, size_t an,
+                        digit_t const* d, size_t dn);
+
+//  q[0..an - dn + 1) = a / d, r[0..dn) = a mod d, an >= dn >= 1 and
+//  d[dn - 1] != 0; recursive by Burnikel and Ziegler
+void divrem(digit_t* q, digit_t* r, digit_t const* a, size_t an,
+            digit_t const* d, size_t dn);
+
+//  name of the kernels in use: "generic", "bmi2", "avx2" or "avx512"
+char const* kernels();
+
+//  switches to the named kernels if this cpu runs them and returns whether
+//  it did; not to be called while other threads do arithmetic
+bool use_kernels(char const* name);
+
+}  // namespace limbs
+
+#endif  // LIMBS_H_
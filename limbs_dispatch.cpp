@@ -0,0 +1,664 @@
+//  Copyright 2019 Nikita Golikov
+
+#include "./limbs.h"
+
+#include <cstring>
+#include <functional>
+
+//  the hot loops are built once per instruction set with the target
+//  attribute of GCC and Clang, and a table picked by cpuid at startup
+//  holds the best set this cpu runs; elsewhere, or with BIGINT_NO_DISPATCH,
+//  only the portable kernels are built
+#if (defined(__GNUC__) && defined(__x86_64__)) && !defined(BIGINT_NO_DISPATCH)
+#define BIGINT_DISPATCH
+#endif
+
+//  add_n, sub_n, mul_1 and submul_1 compile the same for every set, and so
+//  do addmul_1 and mul_basecase with 32-bit limbs; those are called
+//  directly, only the kernels that really differ go through the table
+#if defined(BIGINT_DISPATCH) && defined(BIGINT_LIMB64)
+#define BIGINT_DISPATCH_MUL
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define BIGINT_HAVE_ADDCARRY
+#endif
+
+#ifdef BIGINT_DISPATCH
+#define BIGINT_KERNEL inline __attribute__((always_inline))
+#define BIGINT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BIGINT_KERNEL inline
+#endif
+
+namespace limbs {
+
+namespace {
+
+inline digit_t lo(overflow_t x) {
+  return static_cast<digit_t>(x);
+}
+
+inline digit_t hi(overflow_t x) {
+  return static_cast<digit_t>(x >> DIGITS);
+}
+
+//  *r = a + b + carry, returns the carry out; on x86-64 the intrinsics keep
+//  the carry in the flag register, so add_n becomes a chain of adc
+BIGINT_KERNEL unsigned char add_carry(unsigned char carry, digit_t a,
+                                      digit_t b, digit_t* r) {
+#ifdef BIGINT_HAVE_ADDCARRY
+#ifdef BIGINT_LIMB64
+  unsigned long long sum;
+  carry = _addcarry_u64(carry, a, b, &sum);
+#else
+  unsigned int sum;
+  carry = _addcarry_u32(carry, a, b, &sum);
+#endif
+  *r = sum;
+  return carry;
+#else
+  overflow_t sum = static_cast<overflow_t>(a) + b + carry;
+  *r = lo(sum);
+  return static_cast<unsigned char>(hi(sum));
+#endif
+}
+
+//  *r = a - b - borrow, returns the borrow out, sbb on x86-64
+BIGINT_KERNEL unsigned char sub_borrow(unsigned char borrow, digit_t a,
+                                       digit_t b, digit_t* r) {
+#ifdef BIGINT_HAVE_ADDCARRY
+#ifdef BIGINT_LIMB64
+  unsigned long long diff;
+  borrow = _subborrow_u64(borrow, a, b, &diff);
+#else
+  unsigned int diff;
+  borrow = _subborrow_u32(borrow, a, b, &diff);
+#endif
+  *r = diff;
+  return borrow;
+#else
+  overflow_t diff = static_cast<overflow_t>(a) - b - borrow;
+  *r = lo(diff);
+  return static_cast<unsigned char>(hi(diff) & 1);
+#endif
+}
+
+//  the portable kernels; every instruction set below inlines them into its
+//  own copies, so the compiler may use that set for them
+
+BIGINT_KERNEL digit_t add_n_body(digit_t* r, digit_t const* a,
+                                 digit_t const* b, size_t n) {
+  unsigned char carry = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    carry = add_carry(carry, a[i], b[i], r + i);
+    carry = add_carry(carry, a[i + 1], b[i + 1], r + i + 1);
+    carry = add_carry(carry, a[i + 2], b[i + 2], r + i + 2);
+    carry = add_carry(carry, a[i + 3], b[i + 3], r + i + 3);
+  }
+  for (; i < n; i++) {
+    carry = add_carry(carry, a[i], b[i], r + i);
+  }
+  return carry;
+}
+
+BIGINT_KERNEL digit_t sub_n_body(digit_t* r, digit_t const* a,
+                                 digit_t const* b, size_t n) {
+  unsigned char borrow = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    borrow = sub_borrow(borrow, a[i], b[i], r + i);
+    borrow = sub_borrow(borrow, a[i + 1], b[i + 1], r + i + 1);
+    borrow = sub_borrow(borrow, a[i + 2], b[i + 2], r + i + 2);
+    borrow = sub_borrow(borrow, a[i + 3], b[i + 3], r + i + 3);
+  }
+  for (; i < n; i++) {
+    borrow = sub_borrow(borrow, a[i], b[i], r + i);
+  }
+  return borrow;
+}
+
+BIGINT_KERNEL digit_t mul_1_body(digit_t* r, digit_t const* a, size_t n,
+                                 digit_t b) {
+  digit_t carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    overflow_t t = static_cast<overflow_t>(a[i]) * b + carry;
+    r[i] = lo(t);
+    carry = hi(t);
+  }
+  return carry;
+}
+
+BIGINT_KERNEL digit_t addmul_1_body(digit_t* r, digit_t const* a, size_t n,
+                                    digit_t b) {
+  digit_t carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    overflow_t t = static_cast<overflow_t>(a[i]) * b + r[i] + carry;
+    r[i] = lo(t);
+    carry = hi(t);
+  }
+  return carry;
+}
+
+BIGINT_KERNEL digit_t submul_1_body(digit_t* r, digit_t const* a, size_t n,
+                                    digit_t b) {
+  digit_t borrow = 0;
+  for (size_t i = 0; i < n; i++) {
+    overflow_t t = static_cast<overflow_t>(a[i]) * b + borrow;
+    digit_t sub = lo(t);
+    borrow = hi(t) + (r[i] < sub);
+    r[i] -= sub;
+  }
+  return borrow;
+}
+
+//  one accumulating row per limb of b, straight into the result
+BIGINT_KERNEL void mul_basecase_body(digit_t* r, digit_t const* a, size_t an,
+                                     digit_t const* b, size_t bn) {
+  r[an] = mul_1_body(r, a, an, b[0]);
+  for (size_t j = 1; j < bn; j++) {
+    r[an + j] = addmul_1_body(r + j, a, an, b[j]);
+  }
+}
+
+BIGINT_KERNEL digit_t lshift_body(digit_t* r, digit_t const* a, size_t n,
+                                  unsigned shift) {
+  digit_t out = a[n - 1] >> (DIGITS - shift);
+  for (size_t i = n - 1; i > 0; i--) {
+    r[i] = (a[i] << shift) | (a[i - 1] >> (DIGITS - shift));
+  }
+  r[0] = a[0] << shift;
+  return out;
+}
+
+BIGINT_KERNEL digit_t rshift_body(digit_t* r, digit_t const* a, size_t n,
+                                  unsigned shift) {
+  digit_t out = a[0] << (DIGITS - shift);
+  for (size_t i = 0; i + 1 < n; i++) {
+    r[i] = (a[i] >> shift) | (a[i + 1] << (DIGITS - shift));
+  }
+  r[n - 1] = a[n - 1] >> shift;
+  return out;
+}
+
+template <typename Op>
+BIGINT_KERNEL void bitwise_body(digit_t* r, digit_t const* a,
+                                digit_t const* b, size_t n, Op op) {
+  for (size_t i = 0; i < n; i++) {
+    r[i] = op(a[i], b[i]);
+  }
+}
+
+struct kernel_table {
+  char const* name;
+#ifdef BIGINT_DISPATCH_MUL
+  digit_t (*addmul_1)(digit_t*, digit_t const*, size_t, digit_t);
+  void (*mul_basecase)(digit_t*, digit_t const*, size_t,
+                       digit_t const*, size_t);
+#endif
+  digit_t (*lshift)(digit_t*, digit_t const*, size_t, unsigned);
+  digit_t (*rshift)(digit_t*, digit_t const*, size_t, unsigned);
+  void (*and_n)(digit_t*, digit_t const*, digit_t const*, size_t);
+  void (*ior_n)(digit_t*, digit_t const*, digit_t const*, size_t);
+  void (*xor_n)(digit_t*, digit_t const*, digit_t const*, size_t);
+};
+
+#ifdef BIGINT_DISPATCH_MUL
+
+digit_t addmul_1_generic(digit_t* r, digit_t const* a, size_t n,
+                         digit_t b) {
+  return addmul_1_body(r, a, n, b);
+}
+
+void mul_basecase_generic(digit_t* r, digit_t const* a, size_t an,
+                          digit_t const* b, size_t bn) {
+  mul_basecase_body(r, a, an, b, bn);
+}
+
+#endif
+
+digit_t lshift_generic(digit_t* r, digit_t const* a, size_t n,
+                       unsigned shift) {
+  return lshift_body(r, a, n, shift);
+}
+
+digit_t rshift_generic(digit_t* r, digit_t const* a, size_t n,
+                       unsigned shift) {
+  return rshift_body(r, a, n, shift);
+}
+
+void and_n_generic(digit_t* r, digit_t const* a, digit_t const* b,
+                   size_t n) {
+  bitwise_body(r, a, b, n, std::bit_and<>());
+}
+
+void ior_n_generic(digit_t* r, digit_t const* a, digit_t const* b,
+                   size_t n) {
+  bitwise_body(r, a, b, n, std::bit_or<>());
+}
+
+void xor_n_generic(digit_t* r, digit_t const* a, digit_t const* b,
+                   size_t n) {
+  bitwise_body(r, a, b, n, std::bit_xor<>());
+}
+
+kernel_table const generic_kernels = {
+  "generic",
+#ifdef BIGINT_DISPATCH_MUL
+  addmul_1_generic, mul_basecase_generic,
+#endif
+  lshift_generic, rshift_generic, and_n_generic, ior_n_generic, xor_n_generic
+};
+
+#ifdef BIGINT_DISPATCH
+
+//  BMI2 and ADX only pay off for 64-bit limbs: mulx gives the 128-bit
+//  product without touching the flags, so the high halves and r can be
+//  added in two independent carry chains, adcx on CF and adox on OF; the
+//  32-bit products are plain 64-bit multiplications, so there only the
+//  shifts get shlx and shrx
+
+#ifdef BIGINT_DISPATCH_MUL
+
+//  GCC turns _addcarryx_u64 into adc and saves the flag between the two
+//  chains, so the loop is written out; lea and jrcxz step it without
+//  touching CF or OF, and the carry out of addmul_1 fits in a limb, so the
+//  last high half takes both chains without overflow
+BIGINT_TARGET("bmi2,adx") BIGINT_KERNEL
+digit_t addmul_1_mulx_body(digit_t* r, digit_t const* a, size_t n,
+                           digit_t b) {
+  if (n == 0) {
+    return 0;
+  }
+  long long i = -static_cast<long long>(n);
+  digit_t high, low, next;
+  asm("xor %k[high], %k[high]\n\t"
+      "1:\n\t"
+      "mulx (%[a],%[i],8), %[low], %[next]\n\t"
+      "adcx %[high], %[low]\n\t"
+      "adox (%[r],%[i],8), %[low]\n\t"
+      "mov %[low], (%[r],%[i],8)\n\t"
+      "mov %[next], %[high]\n\t"
+      "lea 1(%[i]), %[i]\n\t"
+      "jrcxz 2f\n\t"
+      "jmp 1b\n\t"
+      "2:\n\t"
+      "mov $0, %k[low]\n\t"
+      "adcx %[low], %[high]\n\t"
+      "adox %[low], %[high]"
+      : [high] "=&r"(high), [low] "=&r"(low), [next] "=&r"(next),
+        [i] "+c"(i)
+      : [a] "r"(a + n), [r] "r"(r + n), "d"(b)
+      : "cc", "memory");
+  return high;
+}
+
+BIGINT_TARGET("bmi2,adx")
+digit_t addmul_1_bmi2(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  return addmul_1_mulx_body(r, a, n, b);
+}
+
+BIGINT_TARGET("bmi2,adx")
+void mul_basecase_bmi2(digit_t* r, digit_t const* a, size_t an,
+                       digit_t const* b, size_t bn) {
+  r[an] = mul_1_body(r, a, an, b[0]);
+  for (size_t j = 1; j < bn; j++) {
+    r[an + j] = addmul_1_mulx_body(r + j, a, an, b[j]);
+  }
+}
+
+#endif
+
+BIGINT_TARGET("bmi2,adx")
+digit_t lshift_bmi2(digit_t* r, digit_t const* a, size_t n,
+                    unsigned shift) {
+  return lshift_body(r, a, n, shift);
+}
+
+BIGINT_TARGET("bmi2,adx")
+digit_t rshift_bmi2(digit_t* r, digit_t const* a, size_t n,
+                    unsigned shift) {
+  return rshift_body(r, a, n, shift);
+}
+
+//  the bitwise operations work on whole vectors and leave the few limbs
+//  past the last one to the portable loop
+
+BIGINT_TARGET("avx2")
+void and_n_avx2(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  size_t const step = sizeof(__m256i) / sizeof(digit_t);
+  size_t i = 0;
+  for (; i + step <= n; i += step) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i),
+                        _mm256_and_si256(x, y));
+  }
+  bitwise_body(r + i, a + i, b + i, n - i, std::bit_and<>());
+}
+
+BIGINT_TARGET("avx2")
+void ior_n_avx2(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  size_t const step = sizeof(__m256i) / sizeof(digit_t);
+  size_t i = 0;
+  for (; i + step <= n; i += step) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i),
+                        _mm256_or_si256(x, y));
+  }
+  bitwise_body(r + i, a + i, b + i, n - i, std::bit_or<>());
+}
+
+BIGINT_TARGET("avx2")
+void xor_n_avx2(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  size_t const step = sizeof(__m256i) / sizeof(digit_t);
+  size_t i = 0;
+  for (; i + step <= n; i += step) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + i));
+    __m256i y = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i),
+                        _mm256_xor_si256(x, y));
+  }
+  bitwise_body(r + i, a + i, b + i, n - i, std::bit_xor<>());
+}
+
+BIGINT_TARGET("avx512f")
+void and_n_avx512(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  size_t const step = sizeof(__m512i) / sizeof(digit_t);
+  size_t i = 0;
+  for (; i + step <= n; i += step) {
+    __m512i x = _mm512_loadu_si512(a + i);
+    __m512i y = _mm512_loadu_si512(b + i);
+    _mm512_storeu_si512(r + i, _mm512_and_si512(x, y));
+  }
+  bitwise_body(r + i, a + i, b + i, n - i, std::bit_and<>());
+}
+
+BIGINT_TARGET("avx512f")
+void ior_n_avx512(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  size_t const step = sizeof(__m512i) / sizeof(digit_t);
+  size_t i = 0;
+  for (; i + step <= n; i += step) {
+    __m512i x = _mm512_loadu_si512(a + i);
+    __m512i y = _mm512_loadu_si512(b + i);
+    _mm512_storeu_si512(r + i, _mm512_or_si512(x, y));
+  }
+  bitwise_body(r + i, a + i, b + i, n - i, std::bit_or<>());
+}
+
+BIGINT_TARGET("avx512f")
+void xor_n_avx512(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  size_t const step = sizeof(__m512i) / sizeof(digit_t);
+  size_t i = 0;
+  for (; i + step <= n; i += step) {
+    __m512i x = _mm512_loadu_si512(a + i);
+    __m512i y = _mm512_loadu_si512(b + i);
+    _mm512_storeu_si512(r + i, _mm512_xor_si512(x, y));
+  }
+  bitwise_body(r + i, a + i, b + i, n - i, std::bit_xor<>());
+}
+
+//  the shifts combine two unaligned loads of adjacent limbs, which avoids
+//  passing bits from lane to lane; lshift goes downwards and rshift upwards
+//  and every block is loaded before it is stored, so r may still equal a
+
+BIGINT_TARGET("avx2")
+inline __m256i shift_left(__m256i x, __m128i count) {
+  return sizeof(digit_t) == 8 ? _mm256_sll_epi64(x, count)
+                              : _mm256_sll_epi32(x, count);
+}
+
+BIGINT_TARGET("avx2")
+inline __m256i shift_right(__m256i x, __m128i count) {
+  return sizeof(digit_t) == 8 ? _mm256_srl_epi64(x, count)
+                              : _mm256_srl_epi32(x, count);
+}
+
+BIGINT_TARGET("avx2")
+digit_t lshift_avx2(digit_t* r, digit_t const* a, size_t n,
+                    unsigned shift) {
+  size_t const step = sizeof(__m256i) / sizeof(digit_t);
+  __m128i left = _mm_cvtsi32_si128(static_cast<int>(shift));
+  __m128i right = _mm_cvtsi32_si128(static_cast<int>(DIGITS - shift));
+  digit_t out = a[n - 1] >> (DIGITS - shift);
+  size_t i = n;
+  for (; i > step; i -= step) {
+    __m256i high = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(a + i - step));
+    __m256i low = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(a + i - step - 1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i - step),
+                        _mm256_or_si256(shift_left(high, left),
+                                        shift_right(low, right)));
+  }
+  lshift_body(r, a, i, shift);
+  return out;
+}
+
+BIGINT_TARGET("avx2")
+digit_t rshift_avx2(digit_t* r, digit_t const* a, size_t n,
+                    unsigned shift) {
+  size_t const step = sizeof(__m256i) / sizeof(digit_t);
+  __m128i right = _mm_cvtsi32_si128(static_cast<int>(shift));
+  __m128i left = _mm_cvtsi32_si128(static_cast<int>(DIGITS - shift));
+  digit_t out = a[0] << (DIGITS - shift);
+  size_t i = 0;
+  for (; i + step < n; i += step) {
+    __m256i low = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(a + i));
+    __m256i high = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(a + i + 1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i),
+                        _mm256_or_si256(shift_right(low, right),
+                                        shift_left(high, left)));
+  }
+  rshift_body(r + i, a + i, n - i, shift);
+  return out;
+}
+
+//  the zero-masking forms, as the plain ones start from an undefined vector
+//  that GCC 12 warns about
+BIGINT_TARGET("avx512f")
+inline __m512i shift_left(__m512i x, __m128i count) {
+  return sizeof(digit_t) == 8
+         ? _mm512_maskz_sll_epi64(static_cast<__mmask8>(-1), x, count)
+         : _mm512_maskz_sll_epi32(static_cast<__mmask16>(-1), x, count);
+}
+
+BIGINT_TARGET("avx512f")
+inline __m512i shift_right(__m512i x, __m128i count) {
+  return sizeof(digit_t) == 8
+         ? _mm512_maskz_srl_epi64(static_cast<__mmask8>(-1), x, count)
+         : _mm512_maskz_srl_epi32(static_cast<__mmask16>(-1), x, count);
+}
+
+BIGINT_TARGET("avx512f")
+digit_t lshift_avx512(digit_t* r, digit_t const* a, size_t n,
+                      unsigned shift) {
+  size_t const step = sizeof(__m512i) / sizeof(digit_t);
+  __m128i left = _mm_cvtsi32_si128(static_cast<int>(shift));
+  __m128i right = _mm_cvtsi32_si128(static_cast<int>(DIGITS - shift));
+  digit_t out = a[n - 1] >> (DIGITS - shift);
+  size_t i = n;
+  for (; i > step; i -= step) {
+    __m512i high = _mm512_loadu_si512(a + i - step);
+    __m512i low = _mm512_loadu_si512(a + i - step - 1);
+    _mm512_storeu_si512(r + i - step,
+                        _mm512_or_si512(shift_left(high, left),
+                                        shift_right(low, right)));
+  }
+  lshift_body(r, a, i, shift);
+  return out;
+}
+
+BIGINT_TARGET("avx512f")
+digit_t rshift_avx512(digit_t* r, digit_t const* a, size_t n,
+                      unsigned shift) {
+  size_t const step = sizeof(__m512i) / sizeof(digit_t);
+  __m128i right = _mm_cvtsi32_si128(static_cast<int>(shift));
+  __m128i left = _mm_cvtsi32_si128(static_cast<int>(DIGITS - shift));
+  digit_t out = a[0] << (DIGITS - shift);
+  size_t i = 0;
+  for (; i + step < n; i += step) {
+    __m512i low = _mm512_loadu_si512(a + i);
+    __m512i high = _mm512_loadu_si512(a + i + 1);
+    _mm512_storeu_si512(r + i,
+                        _mm512_or_si512(shift_right(low, right),
+                                        shift_left(high, left)));
+  }
+  rshift_body(r + i, a + i, n - i, shift);
+  return out;
+}
+
+//  every level includes the one before it, as every cpu with AVX2 or
+//  AVX-512 so far has BMI2 and ADX too
+
+kernel_table const bmi2_kernels = {
+  "bmi2",
+#ifdef BIGINT_DISPATCH_MUL
+  addmul_1_bmi2, mul_basecase_bmi2,
+#endif
+  lshift_bmi2, rshift_bmi2, and_n_generic, ior_n_generic, xor_n_generic
+};
+
+kernel_table const avx2_kernels = {
+  "avx2",
+#ifdef BIGINT_DISPATCH_MUL
+  addmul_1_bmi2, mul_basecase_bmi2,
+#endif
+  lshift_avx2, rshift_avx2, and_n_avx2, ior_n_avx2, xor_n_avx2
+};
+
+kernel_table const avx512_kernels = {
+  "avx512",
+#ifdef BIGINT_DISPATCH_MUL
+  addmul_1_bmi2, mul_basecase_bmi2,
+#endif
+  lshift_avx512, rshift_avx512, and_n_avx512, ior_n_avx512, xor_n_avx512
+};
+
+kernel_table const* const all_kernels[] = {
+  &avx512_kernels, &avx2_kernels, &bmi2_kernels, &generic_kernels
+};
+
+bool runs(kernel_table const* table) {
+  __builtin_cpu_init();
+  bool bmi2 = __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+  if (table == &avx512_kernels) {
+    return bmi2 && __builtin_cpu_supports("avx512f");
+  }
+  if (table == &avx2_kernels) {
+    return bmi2 && __builtin_cpu_supports("avx2");
+  }
+  return table == &generic_kernels || bmi2;
+}
+
+#else
+
+kernel_table const* const all_kernels[] = {&generic_kernels};
+
+bool runs(kernel_table const*) {
+  return true;
+}
+
+#endif
+
+kernel_table const* best_kernels() {
+  for (kernel_table const* table : all_kernels) {
+    if (runs(table)) {
+      return table;
+    }
+  }
+  return &generic_kernels;
+}
+
+//  constant initialized, so code running before the dynamic initializer
+//  below, from the constructors of other files, gets the portable kernels
+kernel_table const* active = &generic_kernels;
+
+struct pick_kernels {
+  pick_kernels() {
+    active = best_kernels();
+  }
+} const at_startup;
+
+}  // namespace
+
+char const* kernels() {
+  return active->name;
+}
+
+bool use_kernels(char const* name) {
+  for (kernel_table const* table : all_kernels) {
+    if (std::strcmp(table->name, name) == 0 && runs(table)) {
+      active = table;
+      return true;
+    }
+  }
+  return false;
+}
+
+digit_t add_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  return add_n_body(r, a, b, n);
+}
+
+digit_t sub_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  return sub_n_body(r, a, b, n);
+}
+
+digit_t mul_1(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  return mul_1_body(r, a, n, b);
+}
+
+digit_t submul_1(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  return submul_1_body(r, a, n, b);
+}
+
+#ifdef BIGINT_DISPATCH_MUL
+
+digit_t addmul_1(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  return active->addmul_1(r, a, n, b);
+}
+
+void mul_basecase(digit_t* r, digit_t const* a, size_t an,
+                  digit_t const* b, size_t bn) {
+  active->mul_basecase(r, a, an, b, bn);
+}
+
+#else
+
+digit_t addmul_1(digit_t* r, digit_t const* a, size_t n, digit_t b) {
+  return addmul_1_body(r, a, n, b);
+}
+
+void mul_basecase(digit_t* r, digit_t const* a, size_t an,
+                  digit_t const* b, size_t bn) {
+  mul_basecase_body(r, a, an, b, bn);
+}
+
+#endif
+
+digit_t lshift(digit_t* r, digit_t const* a, size_t n, unsigned shift) {
+  return active->lshift(r, a, n, shift);
+}
+
+digit_t rshift(digit_t* r, digit_t const* a, size_t n, unsigned shift) {
+  return active->rshift(r, a, n, shift);
+}
+
+void and_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  active->and_n(r, a, b, n);
+}
+
+void ior_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  active->ior_n(r, a, b, n);
+}
+
+void xor_n(digit_t* r, digit_t const* a, digit_t const* b, size_t n) {
+  active->xor_n(r, a, b, n);
+}
+
+}  // namespace limbs
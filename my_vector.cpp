@@ -1,183 +1,268 @@
 //  Copyright 2019 Nikita Golikov
 
+#include <algorithm>
 #include <iostream>
+#include <new>
 #include "./my_vector.h"
 
-template <typename T>
-my_vector<T>::my_vector(T const& x) : _size(1), is_small(true), small(x) {
+template <typename T, size_t N>
+my_vector<T, N>::my_vector(T const& x) : _size(1), is_small(true) {
+  small[0] = x;
 }
 
-template <typename T>
-T& my_vector<T>::operator[](size_t at) {
-  assure_modifiable();
-  return is_small ? small : (*vec)[at];
+template <typename T, size_t N>
+my_vector<T, N>::my_vector(my_vector const& other)
+        : _size(other._size), is_small(other.is_small), buf(other.buf),
+          offset(other.offset) {
+  std::copy(other.small, other.small + N, small);
+  if (!is_small) {
+#ifdef BIGINT_NO_COW
+    buf = allocate(_size);
+    offset = 0;
+    std::copy(other.data(), other.data() + _size, buf->items());
+#else
+    //  the new reference is made from an existing one, so no ordering
+    //  is needed
+    buf->refs.fetch_add(1, std::memory_order_relaxed);
+#endif
+  }
+}
+
+template <typename T, size_t N>
+my_vector<T, N>::my_vector(my_vector&& other) noexcept
+        : _size(other._size), is_small(other.is_small), buf(other.buf),
+          offset(other.offset) {
+  std::copy(other.small, other.small + N, small);
+  other._size = 0;
+  other.is_small = true;
+  other.buf = nullptr;
+}
+
+template <typename T, size_t N>
+my_vector<T, N>& my_vector<T, N>::operator=(my_vector const& other) {
+  my_vector copy(other);
+  swap(copy);
+  return *this;
 }
 
-template <typename T>
-T const& my_vector<T>::operator[](size_t at) const {
-  return is_small ? small : (*vec)[at];
+template <typename T, size_t N>
+my_vector<T, N>& my_vector<T, N>::operator=(my_vector&& other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  release();
+  _size = other._size;
+  is_small = other.is_small;
+  std::copy(other.small, other.small + N, small);
+  buf = other.buf;
+  offset = other.offset;
+  other._size = 0;
+  other.is_small = true;
+  other.buf = nullptr;
+  return *this;
 }
 
-template <typename T>
-T& my_vector<T>::back() {
+template <typename T, size_t N>
+my_vector<T, N>::~my_vector() {
+  release();
+}
+
+template <typename T, size_t N>
+T& my_vector<T, N>::operator[](size_t at) {
+  return data()[at];
+}
+
+template <typename T, size_t N>
+T const& my_vector<T, N>::operator[](size_t at) const {
+  return data()[at];
+}
+
+template <typename T, size_t N>
+T& my_vector<T, N>::back() {
   return (*this)[size() - 1];
 }
 
-template <typename T>
-T const& my_vector<T>::back() const {
+template <typename T, size_t N>
+T const& my_vector<T, N>::back() const {
   return (*this)[size() - 1];
 }
 
-template <typename T>
-bool my_vector<T>::empty() const {
+template <typename T, size_t N>
+bool my_vector<T, N>::empty() const {
   return size() == 0;
 }
 
-template <typename T>
-void my_vector<T>::pop_back() {
+template <typename T, size_t N>
+void my_vector<T, N>::pop_back() {
   assure_modifiable();
-  if (is_small) {
-    small.~T();
-  } else {
-    vec->pop_back();
-  }
   _size--;
 }
 
-template <typename T>
-void my_vector<T>::resize(size_t n, T const& val) {
+template <typename T, size_t N>
+void my_vector<T, N>::resize(size_t n, T const& val) {
   if (n == size() || n == 0) {
     return;
   }
-  assure_modifiable();
-  if (is_small) {
-    if (n == 1) {
-      small = val;
-    } else {
-      make_big();
-    }
-  }
-  if (!is_small) {
-    vec->resize(n, val);
+  reserve(n);
+  if (n > size()) {
+    std::fill(data() + size(), data() + n, val);
   }
   _size = n;
 }
 
-template <typename T>
-bool my_vector<T>::operator==(my_vector<T> const& other) const {
-  if (size() != other.size()) {
-    return false;
-  }
-  if (empty()) {
-    return true;
-  }
-  if (size() > 1) {
-    return *vec == *other.vec;
-  }
-  return back() == other.back();
+template <typename T, size_t N>
+bool my_vector<T, N>::operator==(my_vector const& other) const {
+  return size() == other.size()
+         && std::equal(data(), data() + size(), other.data());
 }
 
-template <typename T>
-size_t my_vector<T>::size() const {
+template <typename T, size_t N>
+size_t my_vector<T, N>::size() const {
   return _size;
 }
 
-template <typename T>
-void my_vector<T>::swap(my_vector<T>& other) {
-  assure_modifiable();
-  other.assure_modifiable();
+template <typename T, size_t N>
+size_t my_vector<T, N>::capacity() const {
+  return is_small ? N : buf->capacity - offset;
+}
 
+template <typename T, size_t N>
+void my_vector<T, N>::swap(my_vector& other) {
   using std::swap;
 
   swap(_size, other._size);
   swap(is_small, other.is_small);
   swap(small, other.small);
-  swap(vec, other.vec);
+  swap(buf, other.buf);
+  swap(offset, other.offset);
 }
 
-template <typename T>
-void my_vector<T>::push_front(T const& val, size_t n) {
+template <typename T, size_t N>
+void my_vector<T, N>::push_front(T const& val, size_t n) {
   if (n == 0) {
     return;
   }
-  assure_modifiable();
-
   size_t new_size = size() + n;
-  if (is_small) {
-    if (new_size == 1) {
-      small = val;
-    } else {
-      make_big();
+  if (is_small && new_size <= N) {
+    for (size_t i = size(); i-- > 0;) {
+      small[i + n] = small[i];
     }
+    std::fill(small, small + n, val);
+    _size = new_size;
+    return;
   }
-  if (!is_small) {
-    vec->insert(vec->begin(), n, val);
+  assure_modifiable();
+  if (is_small || offset < n) {
+    //  as much headroom as there are elements, so repeated pushes are
+    //  amortized O(n)
+    reallocate(std::max(new_size, capacity()), new_size);
   }
-  _size += n;
+  offset -= n;
+  std::fill(buf->items() + offset, buf->items() + offset + n, val);
+  _size = new_size;
 }
 
-template <typename T>
-void my_vector<T>::push_back(T const& val) {
-  assure_modifiable();
-
-  if (is_small) {
-    if (empty()) {
-      small = val;
-    } else {
-      make_big();
-    }
-  }
-  if (!is_small) {
-    vec->push_back(val);
-  }
+template <typename T, size_t N>
+void my_vector<T, N>::push_back(T const& val) {
+  reserve(size() + 1);
+  data()[size()] = val;
   _size++;
 }
 
-template <typename T>
-void my_vector<T>::pop_front(size_t n) {
+template <typename T, size_t N>
+void my_vector<T, N>::pop_front(size_t n) {
   if (n == 0) {
     return;
   }
-  assure_modifiable();
-
   if (is_small) {
-    small.~T();
+    std::copy(small + n, small + size(), small);
+  } else if (n == size()) {
+    //  nothing is left to see, so the buffer is let go at once
+    release();
+    is_small = true;
+    buf = nullptr;
   } else {
-    vec->erase(vec->begin(), vec->begin() + n);
+    //  a shared buffer is only read, so each vector may see it from
+    //  a different offset
+    offset += n;
   }
   _size -= n;
 }
 
-template <typename T>
-void my_vector<T>::make_big() {
+template <typename T, size_t N>
+typename my_vector<T, N>::buffer* my_vector<T, N>::allocate(size_t capacity) {
+  void* memory = ::operator new(sizeof(buffer) + capacity * sizeof(T));
+#ifdef BIGINT_NO_COW
+  return new(memory) buffer{capacity};
+#else
+  return new(memory) buffer{1, capacity};
+#endif
+}
+
+template <typename T, size_t N>
+void my_vector<T, N>::release() {
+#ifdef BIGINT_NO_COW
   if (!is_small) {
-    return;
+    ::operator delete(buf);
   }
+#else
+  //  the release decrement and the acquire fence order every access
+  //  through the other references before the buffer is freed
+  if (!is_small && buf->refs.fetch_sub(1, std::memory_order_release) == 1) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    ::operator delete(buf);
+  }
+#endif
+}
+
+//  moves the elements into an own buffer with room for capacity of them
+//  after front free slots
+template <typename T, size_t N>
+void my_vector<T, N>::reallocate(size_t capacity, size_t front) {
+  buffer* fresh = allocate(front + capacity);
+  T const* items = std::as_const(*this).data();
+  std::copy(items, items + size(), fresh->items() + front);
+  release();
   is_small = false;
-  vec = std::make_shared<std::vector<T>>(empty() ? std::vector<T>()
-                                                 : std::vector<T>{
-                  std::move(small)});
+  buf = fresh;
+  offset = front;
 }
 
-template <typename T>
-void my_vector<T>::assure_modifiable() {
-  if (is_small || vec.unique()) {
-    return;
+//  makes room for n elements in storage owned by this vector alone
+template <typename T, size_t N>
+void my_vector<T, N>::reserve(size_t n) {
+  if (n <= capacity()) {
+    assure_modifiable();
+  } else {
+    reallocate(std::max(n, 2 * capacity()), 0);
   }
-  std::vector<T> copy = *vec;
-  vec = std::make_shared<std::vector<T>>(std::move(copy));
 }
 
-template <typename T>
-T* my_vector<T>::data() {
-  assure_modifiable();
-  return is_small ? &small : vec->data();
+template <typename T, size_t N>
+void my_vector<T, N>::assure_modifiable() {
+#ifndef BIGINT_NO_COW
+  //  a sole owner may write in place: the acquire load sees every release
+  //  of the references other threads dropped before
+  if (is_small || buf->refs.load(std::memory_order_acquire) == 1) {
+    return;
+  }
+  reallocate(capacity(), 0);
+#endif
 }
 
-template <typename T>
-T const* my_vector<T>::data() const {
-  return is_small ? &small : vec->data();
+template <typename T, size_t N>
+bool my_vector<T, N>::shares_storage(my_vector const& other) const {
+  return !is_small && !other.is_small && buf == other.buf
+         && offset == other.offset && _size == other._size;
 }
 
+template <typename T, size_t N>
+T* my_vector<T, N>::data() {
+  assure_modifiable();
+  return is_small ? small : buf->items() + offset;
+}
 
-
+template <typename T, size_t N>
+T const* my_vector<T, N>::data() const {
+  return is_small ? small : buf->items() + offset;
+}
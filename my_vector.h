@@ -3,15 +3,42 @@
 #ifndef MY_VECTOR_H_
 #define MY_VECTOR_H_
 
+#include <atomic>
 #include <cstddef>
-#include <vector>
-#include <memory>
+#include <type_traits>
 #include <utility>
 
-template <typename T>
+//  up to N elements are kept inline, longer vectors share a copy-on-write
+//  heap buffer that holds its reference count and capacity in front of the
+//  elements, so it takes a single allocation; a vector sees its elements
+//  from an offset into the buffer, which makes pop_front O(1) and leaves
+//  headroom for push_front
+//
+//  the reference count is atomic: vectors that share a buffer may be read
+//  and modified from different threads at the same time, a writer copies
+//  the buffer unless it holds the only reference; as with the standard
+//  containers, one vector object must not be modified while another thread
+//  uses that same object; with BIGINT_NO_COW defined copies never share
+//  and the buffer has no reference count at all
+template <typename T, size_t N = 4>
 struct my_vector {
+  static_assert(N >= 1, "my_vector needs room for one inline element");
+  static_assert(std::is_trivially_copyable<T>::value,
+                "my_vector moves its elements as raw memory");
+
   explicit my_vector(T const& x);
 
+  my_vector(my_vector const& other);
+
+  //  the moved-from vector is left empty
+  my_vector(my_vector&& other) noexcept;
+
+  my_vector& operator=(my_vector const& other);
+
+  my_vector& operator=(my_vector&& other) noexcept;
+
+  ~my_vector();
+
   T* data();
 
   T const* data() const;
@@ -30,11 +57,13 @@ struct my_vector {
 
   void resize(size_t n, T const& val);
 
-  bool operator==(my_vector<T> const& other) const;
+  bool operator==(my_vector const& other) const;
 
   size_t size() const;
 
-  void swap(my_vector<T>& other);
+  size_t capacity() const;
+
+  void swap(my_vector& other);
 
   void push_front(T const& val, size_t n = 1);
 
@@ -42,14 +71,37 @@ struct my_vector {
 
   void pop_front(size_t n);
 
+  //  whether both vectors see the same elements of one heap buffer, which
+  //  makes them equal
+  bool shares_storage(my_vector const& other) const;
+
  private:
+  struct buffer {
+#ifndef BIGINT_NO_COW
+    std::atomic<size_t> refs;
+#endif
+    size_t capacity;
+
+    T* items() {
+      return reinterpret_cast<T*>(this + 1);
+    }
+  };
+
+  static_assert(alignof(T) <= alignof(buffer),
+                "elements must fit right after the buffer header");
+
   size_t _size{};
   bool is_small;
 
-  T small;
-  std::shared_ptr<std::vector<T>> vec;
+  T small[N]{};
+  buffer* buf{};
+  size_t offset{};
+
+  static buffer* allocate(size_t capacity);
+  void release();
 
-  void make_big();
+  void reallocate(size_t capacity, size_t front);
+  void reserve(size_t n);
   void assure_modifiable();
 };
 